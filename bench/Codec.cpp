@@ -0,0 +1,208 @@
+// Codec.cpp
+
+#include <Arduino.h>
+#include <chrono>
+#include "Codec.h"
+#include "TelemetryCodec.h"
+
+#define CODEC_ROWS     32   // TELEMETRY_MAX_BATCH
+#define CODEC_COLUMNS  8
+#define CODEC_CADENCE  200  // ms, a dense live batch
+
+static const char* NAMES[CODEC_COLUMNS] = { "lvl", "p", "e", "ct", "thd", "v", "pf", "hz" };
+static const uint8_t DECIMALS[CODEC_COLUMNS] = { 1, 1, 4, 2, 1, 1, 2, 2 };
+
+// Small uniform noise, deterministic
+static float jitter(uint32_t& seed, float amplitude) {
+    seed = seed * 1664525u + 1013904223u;
+    return ((seed >> 8) / 16777216.0f * 2.0f - 1.0f) * amplitude;
+}
+
+// Decodes a batch and compares it with the rows it was made from, at the
+// precision of each column. Returns the mismatches; `decoded` gets the rows
+// that came back. A batch that does not parse counts as one mismatch.
+static uint16_t roundTrip(const uint8_t* buffer, size_t length, const uint32_t* times, const float* rows,
+                          uint8_t columns, const uint8_t* decimals, uint16_t& decoded) {
+    TelemetryDecoder decoder;
+    decoded = 0;
+    if (!decoder.begin(buffer, length) || decoder.getColumnCount() != columns) return 1;
+
+    uint16_t mismatches = 0;
+    uint32_t time;
+    float values[TELEMETRY_CODEC_MAX_COLUMNS];
+    while (decoder.next(time, values)) {
+        if (time != times[decoded]) mismatches++;
+        for (uint8_t c = 0; c < columns; c++) {
+            float scale = powf(10.0f, decimals[c]);
+            float expected = roundf(rows[decoded * columns + c] * scale) / scale;
+            if (fabsf(values[c] - expected) > 0.5f / scale) mismatches++;
+        }
+        decoded++;
+    }
+    return mismatches;
+}
+
+// Checks outside the dense live batch: timestamp fallbacks, signed values,
+// a full buffer and truncated input. Returns the number of failed checks.
+static int checkCodecEdges() {
+    static const char* names[3] = { "p", "lvl", "pf" };
+    static const uint8_t decimals[3] = { 1, 1, 2 };
+    const uint32_t t0 = 0xFFFFF000; // millis() wraps inside the batch
+    const uint32_t times[] = {
+        t0, t0 + 200, t0 + 400,
+        t0 + 5400,                  // Gap > 2048 ms: plain 32-bit delta
+        t0 + 5300,                  // Clock stepped back
+        t0 + 5300,                  // Same time twice
+        t0 + 9000, t0 + 9200,       // Across the wrap
+    };
+    const float rows[][3] = {
+        { 400.0f, 62.5f, 0.95f },
+        { -12.3f, -1.0f, -0.50f },  // Negative power, "no reading" level
+        { 0.0f, -1.0f, 0.0f },
+        { 6553.5f, 100.0f, 1.0f },
+        { -6553.5f, 0.1f, -1.0f },
+        { 0.05f, -1.0f, 0.005f },   // Rounds half away from zero
+        { 1e6f, -1e6f, 0.01f },
+        { 400.0f, 62.5f, 0.95f },
+    };
+    const uint16_t count = sizeof(times) / sizeof(times[0]);
+    int failures = 0;
+
+    static uint8_t buffer[512];
+    TelemetryEncoder encoder;
+    encoder.begin(buffer, sizeof(buffer), 7, t0, 0, names, decimals, 3);
+    for (uint16_t r = 0; r < count; r++) encoder.addRow(times[r], rows[r]);
+    size_t length = encoder.finish();
+    uint16_t decoded;
+    uint16_t mismatches = roundTrip(buffer, length, times, &rows[0][0], 3, decimals, decoded);
+    uint16_t truncations = 0;
+    if (mismatches > 0 || decoded != count) {
+        Serial.printf("FAIL: codec edge rows: %u of %u back, %u mismatches\n", decoded, count, mismatches);
+        failures++;
+    }
+
+    // Every strict prefix must stop early without returning a wrong row
+    for (size_t cut = 0; cut < length; cut++) {
+        mismatches = roundTrip(buffer, cut, times, &rows[0][0], 3, decimals, decoded);
+        truncations++;
+        if (decoded >= count || (decoded > 0 && mismatches > 0)) {
+            Serial.printf("FAIL: codec truncated to %u bytes: %u rows, %u mismatches\n", (unsigned)cut, decoded, mismatches);
+            failures++;
+        }
+    }
+
+    // A full buffer rejects the row that does not fit and keeps the rest intact
+    static uint8_t small[64];
+    encoder.begin(small, sizeof(small), 8, t0, 0, names, decimals, 3);
+    uint16_t accepted = 0;
+    while (accepted < count && encoder.addRow(times[accepted], rows[accepted])) accepted++;
+    length = encoder.finish();
+    mismatches = roundTrip(small, length, times, &rows[0][0], 3, decimals, decoded);
+    if (accepted == count || accepted == 0 || length > sizeof(small) || mismatches > 0 || decoded != accepted) {
+        Serial.printf("FAIL: codec full buffer: %u rows accepted, %u back, %u mismatches\n", accepted, decoded, mismatches);
+        failures++;
+    }
+
+    Serial.printf("   edge cases: %u rows, %u truncations, full buffer after %u rows: %s\n",
+        count, truncations, accepted, failures ? "FAIL" : "ok");
+    return failures;
+}
+
+int benchCodec() {
+    static float rows[CODEC_ROWS][CODEC_COLUMNS];
+    static uint32_t times[CODEC_ROWS];
+    uint32_t seed = 1;
+    double energy = 123.4567;
+    for (uint16_t r = 0; r < CODEC_ROWS; r++) {
+        float power = 400.0f + jitter(seed, 3.0f);
+        energy += power * CODEC_CADENCE / 3.6e9;
+        times[r] = 600000 + r * CODEC_CADENCE + (r == 17 ? 3 : 0); // One late frame
+        float values[CODEC_COLUMNS] = {
+            62.5f, power, (float)energy, 1.74f + jitter(seed, 0.02f),
+            18.0f + jitter(seed, 0.4f), 229.8f + jitter(seed, 0.3f), 0.95f + jitter(seed, 0.01f), 50.0f + jitter(seed, 0.02f)
+        };
+        memcpy(rows[r], values, sizeof(values));
+    }
+
+    // The JSON batch TelemetryPipeline would send for the same rows
+    static char json[4096];
+    int jsonLength = snprintf(json, sizeof(json),
+        "{\"seq\":1,\"t0\":%lu,\"ts\":0,\"cols\":[\"dt\",\"lvl\",\"p\",\"e\",\"ct\",\"thd\",\"v\",\"pf\",\"hz\"],\"rows\":[",
+        (unsigned long)times[0]);
+    for (uint16_t r = 0; r < CODEC_ROWS; r++) {
+        const float* v = rows[r];
+        jsonLength += snprintf(json + jsonLength, sizeof(json) - jsonLength, "%s[%lu,%.1f,%.1f,%.4f,%.2f,%.1f,%.1f,%.2f,%.2f]",
+            r ? "," : "", (unsigned long)(times[r] - times[0]), v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7]);
+    }
+    jsonLength += snprintf(json + jsonLength, sizeof(json) - jsonLength, "]}");
+
+    static uint8_t buffer[2048];
+    TelemetryEncoder encoder;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    encoder.begin(buffer, sizeof(buffer), 1, times[0], 0, NAMES, DECIMALS, CODEC_COLUMNS);
+    for (uint16_t r = 0; r < CODEC_ROWS; r++) encoder.addRow(times[r], rows[r]);
+    size_t length = encoder.finish();
+    double encodeNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    // Round trip: every value must come back at the JSON precision
+    uint16_t decoded;
+    uint16_t mismatches = roundTrip(buffer, length, times, &rows[0][0], CODEC_COLUMNS, DECIMALS, decoded);
+
+    Serial.printf("codec: %d rows x %d columns every %d ms\n", CODEC_ROWS, CODEC_COLUMNS, CODEC_CADENCE);
+    Serial.printf("   JSON   %5d bytes (%.1f per row)\n", jsonLength, (float)jsonLength / CODEC_ROWS);
+    Serial.printf("   binary %5u bytes (%.1f per row), %.1fx smaller, %.0f ns per row to encode\n",
+        (unsigned)length, (float)length / CODEC_ROWS, (float)jsonLength / length, encodeNs / CODEC_ROWS);
+    Serial.printf("   round trip: %u of %d rows, %u mismatches\n", decoded, CODEC_ROWS, mismatches);
+
+    int failures = 0;
+    if (mismatches > 0 || decoded != CODEC_ROWS) {
+        Serial.println("FAIL: codec round trip");
+        failures++;
+    }
+    return failures + checkCodecEdges();
+}
+
+int runDecode(const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        Serial.printf("Cannot open %s\n", path);
+        return 1;
+    }
+    static uint8_t data[65536];
+    size_t length = fread(data, 1, sizeof(data), file);
+    fclose(file);
+
+    TelemetryDecoder decoder;
+    if (!decoder.begin(data, length)) {
+        Serial.printf("%s is not a version %d telemetry batch\n", path, TELEMETRY_CODEC_VERSION);
+        return 1;
+    }
+    Serial.printf("# seq %lu, t0 %lu ms, unix %lu, %u rows, %u bytes\n",
+        (unsigned long)decoder.getSequence(), (unsigned long)decoder.getT0(),
+        (unsigned long)decoder.getUnixStart(), decoder.getRows(), (unsigned)length);
+
+    Serial.printf("t");
+    for (uint8_t c = 0; c < decoder.getColumnCount(); c++) {
+        char name[32];
+        decoder.getColumnName(c, name, sizeof(name));
+        Serial.printf(",%s", name);
+    }
+    Serial.println();
+
+    uint32_t time;
+    float values[TELEMETRY_CODEC_MAX_COLUMNS];
+    uint16_t rows = 0;
+    while (decoder.next(time, values)) {
+        Serial.printf("%lu", (unsigned long)time);
+        for (uint8_t c = 0; c < decoder.getColumnCount(); c++) {
+            Serial.printf(",%.*f", decoder.getDecimals(c), values[c]);
+        }
+        Serial.println();
+        rows++;
+    }
+    if (rows != decoder.getRows()) {
+        Serial.printf("# truncated after %u rows\n", rows);
+        return 1;
+    }
+    return 0;
+}
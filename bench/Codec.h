@@ -0,0 +1,16 @@
+// Codec.h
+
+#ifndef CODEC_H
+#define CODEC_H
+
+// Encodes a dense synthetic batch with TelemetryCodec, decodes it again and
+// prints the size against the JSON batch with the same rows and precision,
+// then checks the edge cases (timestamp fallbacks, negative and "no reading"
+// values, a full buffer, truncated input). Returns the failed checks.
+int benchCodec();
+
+// Reference decoder: prints a binary batch (e.g. saved with
+// mosquitto_sub -t home_iot/+/telemetry/bin -C 1 > batch.bin) as CSV
+int runDecode(const char* path);
+
+#endif // CODEC_H
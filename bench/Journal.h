@@ -0,0 +1,12 @@
+// Journal.h
+
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+// Power-loss check of EnergyJournal on a FileFlashStorage image: cuts the
+// power at several byte offsets inside a record write and inside a sector
+// erase, reboots and expects the last committed energy and peak back.
+// Returns the number of failed cases.
+int benchJournal();
+
+#endif // JOURNAL_H
@@ -0,0 +1,57 @@
+// Replay.cpp
+
+#include <Arduino.h>
+#include <chrono>
+#include "Replay.h"
+#include "ADCSampler.h"
+#include "ADCReplay.h"
+#include "RMSAccumulator.h"
+
+int runReplay(const char* path, float countsPerUnit) {
+    if (!ADCReplay::begin(path, false, false)) {
+        Serial.printf("Cannot replay %s\n", path);
+        return 1;
+    }
+    const ADCCaptureHeader& header = ADCReplay::getHeader();
+    ADCSampler::setSource(ADCReplay::source);
+    ADCSampler::begin(header.pins, header.channelCount, header.sampleRateHz);
+
+    static RMSAccumulator rms[ADC_SAMPLER_MAX_CHANNELS];
+    uint32_t cursors[ADC_SAMPLER_MAX_CHANNELS];
+    for (uint8_t c = 0; c < header.channelCount; c++) {
+        rms[c].begin(header.sampleRateHz);
+        cursors[c] = 0;
+    }
+
+    uint16_t samples[128];
+    uint64_t frames = 0, nextReport = header.sampleRateHz;
+    double ns = 0;
+    while (ADCSampler::poll() > 0) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (uint8_t c = 0; c < header.channelCount; c++) {
+            size_t n;
+            while ((n = ADCSampler::read(header.pins[c], cursors[c], samples, 128)) > 0) {
+                rms[c].push(samples, n);
+            }
+        }
+        ns += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+        frames = ADCSampler::head(header.pins[0]);
+        if (frames < nextReport) continue;
+        nextReport += header.sampleRateHz;
+
+        Serial.printf("%7.1f s", (double)frames / header.sampleRateHz);
+        for (uint8_t c = 0; c < header.channelCount; c++) {
+            Serial.printf(" | GPIO%-2d rms %8.3f mean %7.1f cycle %4lu", header.pins[c],
+                rms[c].rms(5) / countsPerUnit, rms[c].mean(5), (unsigned long)rms[c].getLastCycleSamples());
+        }
+        Serial.println();
+    }
+
+    Serial.printf("\n%lu frames, %lu gap(s), %lu bad block(s), %.1f ns/sample\n",
+        (unsigned long)ADCReplay::getFramesReplayed(), (unsigned long)ADCReplay::getGaps(),
+        (unsigned long)ADCReplay::getBadBlocks(),
+        frames ? ns / ((double)frames * header.channelCount) : 0.0);
+    ADCReplay::end();
+    return 0;
+}
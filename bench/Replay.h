@@ -0,0 +1,11 @@
+// Replay.h
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+// Runs a capture file through ADCSampler and the cycle-aligned RMS code and
+// prints one line per second: per-channel RMS (ADC steps, or divided by
+// countsPerUnit), mean and cycle length, plus the processing cost.
+int runReplay(const char* path, float countsPerUnit);
+
+#endif // REPLAY_H
@@ -0,0 +1,87 @@
+// Waveform.cpp
+
+#include "Waveform.h"
+
+#define TRUTH_STEPS 100000 // Integration steps per period for the ground truth
+
+Waveform::Waveform(const WaveformSpec& spec, float countsPerAmp, uint16_t midPoint, uint16_t maxADC, uint32_t seed)
+    : _spec(spec), _countsPerAmp(countsPerAmp), _midPoint(midPoint), _maxADC(maxADC), _rng(seed) {
+    double period = _spec.type == WAVE_DC ? 1.0 : 1.0 / _spec.frequency;
+    double sum = 0, sumSquares = 0;
+    float minimum = currentAt(0), maximum = minimum;
+    for (uint32_t i = 0; i < TRUTH_STEPS; i++) {
+        float current = currentAt(period * i / TRUTH_STEPS);
+        sum += current;
+        sumSquares += (double)current * current;
+        if (current < minimum) minimum = current;
+        if (current > maximum) maximum = current;
+    }
+    _mean = sum / TRUTH_STEPS;
+    _rms = sqrt(sumSquares / TRUTH_STEPS);
+    _peakToPeak = maximum - minimum;
+
+    // THD from the Fourier series of one period
+    _thd = 0;
+    _fundamental = 0;
+    if (_spec.type == WAVE_DC) return;
+    double harmonics[16] = { 0 };
+    for (int k = 1; k <= 15; k++) {
+        double re = 0, im = 0;
+        for (uint32_t i = 0; i < TRUTH_STEPS; i += 10) {
+            double angle = 2 * M_PI * k * i / TRUTH_STEPS;
+            double current = currentAt(period * i / TRUTH_STEPS);
+            re += current * cos(angle);
+            im += current * sin(angle);
+        }
+        harmonics[k] = sqrt(re * re + im * im);
+    }
+    double distortion = 0;
+    for (int k = 2; k <= 15; k++) distortion += harmonics[k] * harmonics[k];
+    _thd = sqrt(distortion) / harmonics[1] * 100.0;
+    _fundamental = sqrt(2.0) * harmonics[1] / (TRUTH_STEPS / 10);
+}
+
+float Waveform::currentAt(double t) const {
+    if (_spec.type == WAVE_DC) return _spec.amplitude;
+
+    double cycles = t * _spec.frequency;
+    double phase = (cycles - floor(cycles)) * 360.0; // degrees
+    double half = fmod(phase, 180.0);
+    double sign = phase < 180.0 ? 1.0 : -1.0;
+
+    switch (_spec.type) {
+        case WAVE_DIMMER:
+            // Off until the triac fires, then follows the sine to the zero crossing
+            if (half < _spec.shape) return 0.0f;
+            return _spec.amplitude * sin(phase * M_PI / 180.0);
+        case WAVE_SMPS: {
+            // Half-sine pulse centred on the voltage peak
+            double start = 90.0 - _spec.shape / 2;
+            if (half < start || half > start + _spec.shape) return 0.0f;
+            return sign * _spec.amplitude * sin((half - start) * M_PI / _spec.shape);
+        }
+        default:
+            return _spec.amplitude * sin(phase * M_PI / 180.0);
+    }
+}
+
+// xorshift32, so every run sees the same noise
+float Waveform::gaussian() {
+    float sum = 0;
+    for (int i = 0; i < 12; i++) {
+        _rng ^= _rng << 13;
+        _rng ^= _rng >> 17;
+        _rng ^= _rng << 5;
+        sum += (_rng >> 8) / 16777216.0f;
+    }
+    return sum - 6.0f; // Irwin-Hall approximation, sigma = 1
+}
+
+uint16_t Waveform::sample(double t) {
+    float counts = _midPoint + _spec.offsetCounts + currentAt(t) * _countsPerAmp;
+    if (_spec.noiseCounts > 0) counts += gaussian() * _spec.noiseCounts;
+    long value = lroundf(counts);
+    if (value < 0) value = 0;
+    if (value > _maxADC) value = _maxADC;
+    return value;
+}
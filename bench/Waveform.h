@@ -0,0 +1,61 @@
+// Waveform.h
+
+#ifndef WAVEFORM_H
+#define WAVEFORM_H
+
+#include <Arduino.h>
+
+enum WaveformType {
+    WAVE_SINE,    // Resistive load
+    WAVE_DIMMER,  // Leading-edge phase cut (triac dimmer)
+    WAVE_SMPS,    // Capacitor-input rectifier: narrow pulses around the voltage peaks
+    WAVE_DC       // Constant current
+};
+
+struct WaveformSpec {
+    const char* name;
+    WaveformType type;
+    float amplitude;     // Peak current in A (DC: the current)
+    float frequency;     // Hz
+    float shape;         // Dimmer: firing angle in degrees; SMPS: conduction angle in degrees
+    float offsetCounts;  // DC error added to the ideal midpoint
+    float noiseCounts;   // Gaussian noise, RMS in ADC counts
+};
+
+// Synthetic sensor output in ADC counts with an exact ground truth
+class Waveform {
+public:
+    Waveform(const WaveformSpec& spec, float countsPerAmp, uint16_t midPoint, uint16_t maxADC, uint32_t seed = 1);
+
+    // Noise-free current in A at t seconds
+    float currentAt(double t) const;
+
+    // Quantized, clipped ADC reading including offset and noise
+    uint16_t sample(double t);
+
+    // Ground truth over one period, from the noise-free current
+    float trueRMS() const { return _rms; }
+    float truePeakToPeak() const { return _peakToPeak; }
+    float trueMean() const { return _mean; }
+    float trueTHD() const { return _thd; } // %, harmonics 2..15
+    float trueFundamental() const { return _fundamental; } // RMS of harmonic 1
+
+
+    const WaveformSpec& spec() const { return _spec; }
+
+private:
+    float gaussian();
+
+    WaveformSpec _spec;
+    float _countsPerAmp;
+    uint16_t _midPoint;
+    uint16_t _maxADC;
+    uint32_t _rng;
+    float _rms;
+    float _peakToPeak;
+    float _mean;
+    float _thd;
+    float _fundamental;
+};
+
+#endif // WAVEFORM_H
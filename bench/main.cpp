@@ -0,0 +1,369 @@
+// main.cpp - host benchmark for the current measurement algorithms
+//
+// Feeds synthetic waveforms through ACS712 (via setADC) and CTModule (via an
+// ADCSampler source). Reports the error against the exact ground truth (in %,
+// or absolute when the truth is zero) and the host time per processed sample.
+// A few cases are checks rather than measurements; a failed one prints FAIL
+// and makes the program exit with 1.
+//
+//   pio run -e native -t exec             all waveforms
+//   .pio/build/native/program sine-noise  one waveform
+//   .pio/build/native/program --replay capture.adc [counts per A]
+//                                         a raw capture from the device
+//   .pio/build/native/program --decode batch.bin
+//                                         a binary MQTT batch as CSV
+
+#include <Arduino.h>
+#include <chrono>
+#include "ACS712.h"
+#include "ADCSampler.h"
+#include "CTModule.h"
+#include "CTManager.h"
+#include "Waveform.h"
+#include "Replay.h"
+#include "Codec.h"
+#include "Journal.h"
+#include "EnergyMeterModule.h"
+#include "MeteringTask.h"
+#include "FrequencyTracker.h"
+#include "HarmonicAnalyzer.h"
+#include "OffsetTracker.h"
+
+// Same front end as the device: ESP32 ADC, ACS712-5A
+#define ADC_VOLTS       3.3f
+#define ADC_MAX         4095
+#define ADC_MIDPOINT    2048
+#define ACS_MV_PER_AMP  185.0f
+#define ACS_PIN         34
+#define CT_PIN          35
+#define CT_CIRCUITS     8     // Every ADC1 input as a CT
+#define SAMPLE_RATE     10000 // ADCSampler rate per channel
+#define BUFFER_CYCLES   10
+
+static const float COUNTS_PER_AMP = ACS_MV_PER_AMP / (ADC_VOLTS * 1000.0f / ADC_MAX);
+
+static const WaveformSpec WAVEFORMS[] = {
+    // name          type         A     Hz    shape offset noise
+    { "sine",        WAVE_SINE,   2.0f, 50.0f, 0,   0,     0 },
+    { "sine-low",    WAVE_SINE,   0.2f, 50.0f, 0,   0,     2 },
+    { "sine-60hz",   WAVE_SINE,   2.0f, 60.0f, 0,   0,     0 },
+    { "dimmer-90",   WAVE_DIMMER, 2.0f, 50.0f, 90,  0,     0 },
+    { "smps-40",     WAVE_SMPS,   3.0f, 50.0f, 40,  0,     0 },
+    { "sine-offset", WAVE_SINE,   2.0f, 50.0f, 0,   20,    0 },
+    { "sine-noise",  WAVE_SINE,   2.0f, 50.0f, 0,   0,     8 },
+    { "dc",          WAVE_DC,     1.5f, 50.0f, 0,   0,     0 },
+};
+
+#define SIGNAL_TABLE_US 1000000 // Whole periods of 50 and 60 Hz
+
+static Waveform* _waveform = NULL;
+static uint32_t _sourceIndex = 0;
+static uint16_t _signalTable[SIGNAL_TABLE_US];
+
+// Precomputed at 1 us resolution, so analogRead() costs a lookup and the
+// blocking timings are not dominated by the generator
+static uint16_t analogSignal(uint8_t, uint64_t timeUs) {
+    return _signalTable[timeUs % SIGNAL_TABLE_US];
+}
+
+// ADCSampler source: one channel at SAMPLE_RATE, fresh noise per sample
+static size_t samplerSource(uint16_t* frames, size_t maxFrames) {
+    for (size_t i = 0; i < maxFrames; i++) {
+        frames[i] = _waveform->sample((double)_sourceIndex++ / SAMPLE_RATE);
+    }
+    return maxFrames;
+}
+
+// Same sample on every channel of a CT_CIRCUITS-wide frame
+static size_t multiSource(uint16_t* frames, size_t maxFrames) {
+    for (size_t i = 0; i < maxFrames; i++) {
+        uint16_t value = _waveform->sample((double)_sourceIndex++ / SAMPLE_RATE);
+        for (uint8_t c = 0; c < CT_CIRCUITS; c++) frames[i * CT_CIRCUITS + c] = value;
+    }
+    return maxFrames;
+}
+
+typedef std::chrono::steady_clock Clock;
+
+static double elapsedNs(Clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+static void report(const char* waveform, const char* algorithm, float value, float truth, const char* unit, double nsPerSample) {
+    char error[16];
+    if (fabsf(truth) > 1e-3f) {
+        snprintf(error, sizeof(error), "%+8.2f%%", (value - truth) / truth * 100.0f);
+    } else {
+        snprintf(error, sizeof(error), "%+8.4f", value - truth); // absolute
+    }
+    Serial.printf("%-12s %-24s %10.4f %10.4f %-3s %9s %9.1f\n",
+        waveform, algorithm, value, truth, unit, error, nsPerSample);
+}
+
+// Blocking ACS712 calls: samples are the analogRead() calls they made
+template<typename Call>
+static void benchBlocking(const char* waveform, const char* algorithm, float truth, const char* unit, int reps, Call call) {
+    HostShim::resetReadCount();
+    double sum = 0;
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < reps; i++) sum += call();
+    double ns = elapsedNs(start);
+    uint32_t reads = HostShim::getReadCount();
+    report(waveform, algorithm, sum / reps, truth, unit, reads ? ns / reads : 0);
+}
+
+// Buffer calls: the same pre-captured block, processed reps times
+template<typename Call>
+static void benchBuffer(const char* waveform, const char* algorithm, float truth, const char* unit, int reps, uint16_t count, Call call) {
+    double sum = 0;
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < reps; i++) sum += call();
+    double ns = elapsedNs(start);
+    report(waveform, algorithm, sum / reps, truth, unit, ns / ((double)reps * count));
+}
+
+// ns/sample covers CTModule::update() only, not the sampler polling
+static void benchCT(const WaveformSpec& spec, float truth) {
+    const uint8_t pins[] = { CT_PIN };
+    _sourceIndex = 0;
+    ADCSampler::setSource(samplerSource);
+    ADCSampler::begin(pins, 1, SAMPLE_RATE);
+    CTModule::begin(CT_PIN, COUNTS_PER_AMP);
+
+    // Keep the ring from overrunning: ~5 cycles per update at 50 Hz
+    const int rounds = 200;
+    double ns = 0, sum = 0;
+    uint32_t samples = 0;
+    for (int r = 0; r < rounds; r++) {
+        for (int p = 0; p < 16; p++) samples += ADCSampler::poll();
+        Clock::time_point start = Clock::now();
+        CTModule::update();
+        ns += elapsedNs(start);
+        if (r >= rounds / 2) sum += CTModule::getCurrent(CT_RMS_CYCLES);
+    }
+    report(spec.name, "CTModule rms (5 cyc)", sum / (rounds - rounds / 2), truth, "A", ns / samples);
+}
+
+// All ADC1 pins in one scan; ns/sample is per converted sample, every channel
+static void benchCTManager(const WaveformSpec& spec, float truth) {
+    static const uint8_t pins[CT_CIRCUITS] = { 35, 32, 33, 34, 36, 37, 38, 39 };
+    static const char* names[CT_CIRCUITS] = { "main", "c1", "c2", "c3", "c4", "c5", "c6", "c7" };
+    _sourceIndex = 0;
+    ADCSampler::setSource(multiSource);
+    ADCSampler::begin(pins, CT_CIRCUITS, SAMPLE_RATE);
+    for (uint8_t c = 0; c < CT_CIRCUITS; c++) {
+        CTManager::addChannel(pins[c], COUNTS_PER_AMP, names[c]);
+        CTManager::getChannel(c)->setCalibration(COUNTS_PER_AMP);
+    }
+    CTManager::begin();
+
+    // 64 frames per poll: 16 polls stay inside the ring
+    const int rounds = 200;
+    double ns = 0, sum = 0;
+    uint32_t samples = 0;
+    for (int r = 0; r < rounds; r++) {
+        for (int p = 0; p < 16; p++) samples += ADCSampler::poll() * CT_CIRCUITS;
+        Clock::time_point start = Clock::now();
+        CTManager::update();
+        ns += elapsedNs(start);
+        if (r >= rounds / 2) {
+            float worst = CTManager::getChannel(0)->getCurrent(CT_RMS_CYCLES);
+            for (uint8_t c = 1; c < CT_CIRCUITS; c++) {
+                float current = CTManager::getChannel(c)->getCurrent(CT_RMS_CYCLES);
+                if (fabsf(current - truth) > fabsf(worst - truth)) worst = current;
+            }
+            sum += worst;
+        }
+    }
+    report(spec.name, "CTManager 8 ch (worst)", sum / (rounds - rounds / 2), truth, "A", ns / samples);
+}
+
+static void benchWaveform(const WaveformSpec& spec) {
+    Waveform waveform(spec, COUNTS_PER_AMP, ADC_MIDPOINT, ADC_MAX);
+    _waveform = &waveform;
+    for (uint32_t t = 0; t < SIGNAL_TABLE_US; t++) _signalTable[t] = waveform.sample(t / 1e6);
+    HostShim::setSignal(analogSignal);
+    HostShim::setTimeUs(0);
+
+    const bool ac = spec.type != WAVE_DC;
+    const float rms = waveform.trueRMS();
+    const float p2p = waveform.truePeakToPeak();
+    const float frequency = spec.frequency;
+
+    ACS712 acs(ACS_PIN, ADC_VOLTS, ADC_MAX, ACS_MV_PER_AMP);
+    acs.setADC(HostShim::readADC, ADC_VOLTS, ADC_MAX);
+    acs.setMidPoint(ADC_MIDPOINT);
+
+    // --- Blocking API, as the legacy code used it ---
+    if (ac) {
+        benchBlocking(spec.name, "mA_peak2peak", p2p, "A", 50, [&]() { return acs.mA_peak2peak(frequency) / 1000.0f; });
+        benchBlocking(spec.name, "mA_AC (form factor)", rms, "A", 50, [&]() { return acs.mA_AC(frequency) / 1000.0f; });
+        benchBlocking(spec.name, "detectFrequency", frequency, "Hz", 10, [&]() { return acs.detectFrequency(40); });
+    }
+    benchBlocking(spec.name, "mA_AC_sampling", rms, "A", 50, [&]() { return acs.mA_AC_sampling(frequency) / 1000.0f; });
+    benchBlocking(spec.name, "mA_DC", waveform.trueMean(), "A", 50, [&]() { return acs.mA_DC() / 1000.0f; });
+
+    // --- Buffer API over whole cycles at the sampler rate ---
+    static uint16_t buffer[SAMPLE_RATE];
+    uint16_t count = lroundf(BUFFER_CYCLES * SAMPLE_RATE / frequency);
+    for (uint16_t i = 0; i < count; i++) buffer[i] = waveform.sample((double)i / SAMPLE_RATE);
+    if (ac) {
+        benchBuffer(spec.name, "mA_peak2peak_buffer", p2p, "A", 2000, count, [&]() { return acs.mA_peak2peak_buffer(buffer, count) / 1000.0f; });
+    }
+    benchBuffer(spec.name, "mA_AC_sampling_buffer", rms, "A", 2000, count, [&]() { return acs.mA_AC_sampling_buffer(buffer, count) / 1000.0f; });
+    if (ac) {
+        // The block is whole cycles, so pushing it repeatedly is a continuous signal
+        static FrequencyTracker tracker;
+        tracker.begin(SAMPLE_RATE);
+        Clock::time_point start = Clock::now();
+        for (int i = 0; i < 200; i++) tracker.push(buffer, count);
+        double ns = elapsedNs(start);
+        report(spec.name, "FrequencyTracker", tracker.isLocked() ? tracker.getFrequency() : 0.0f,
+            frequency, "Hz", ns / (200.0 * count));
+    }
+
+    // --- Harmonic analysis, one cycle per block ---
+    if (ac) {
+        static HarmonicAnalyzer harmonics;
+        harmonics.begin(1, 1.0f);
+        uint16_t cycle = lroundf(SAMPLE_RATE / frequency);
+        benchBuffer(spec.name, "HarmonicAnalyzer THD", waveform.trueTHD(), "%", 2000, cycle, [&]() {
+            harmonics.pushCycle(buffer, cycle, harmonics.getAnalyzedCycles() * 1000);
+            return harmonics.getTHD();
+        });
+        report(spec.name, "HarmonicAnalyzer h1", harmonics.getHarmonic(1) / COUNTS_PER_AMP,
+            waveform.trueFundamental(), "A", 0);
+    }
+
+    // --- CT path: sampler ring + cycle-aligned RMS ---
+    // The no-load offset absorbs any DC, so the CT only sees the AC part
+    float acRMS = sqrtf(max(0.0f, rms * rms - waveform.trueMean() * waveform.trueMean()));
+    benchCT(spec, acRMS);
+    benchCTManager(spec, acRMS);
+
+    _waveform = NULL;
+}
+
+// Feeds whole 50 Hz cycles of a waveform to an auto-zero, as the meter does
+static void feedZero(OffsetTracker& zero, Waveform& waveform, uint32_t& index, int cycles, uint16_t* cycle) {
+    const uint16_t count = SAMPLE_RATE / 50;
+    for (int c = 0; c < cycles; c++) {
+        double sum = 0, sumSquares = 0;
+        for (uint16_t i = 0; i < count; i++) {
+            cycle[i] = waveform.sample((double)index++ / SAMPLE_RATE);
+            sum += cycle[i];
+            sumSquares += (double)cycle[i] * cycle[i];
+        }
+        float mean = sum / count;
+        zero.addWindow(mean, sqrtf(max(0.0, sumSquares / count - (double)mean * mean)));
+    }
+}
+
+// Auto-zero: 10 s of load right after boot, then a minute idle with a DC
+// error and noise. The load must not move the zero; the idle time must.
+static void benchZero() {
+    const WaveformSpec loadSpec = { "zero", WAVE_SINE, 2.0f, 50.0f, 0, 20, 3 };
+    const WaveformSpec idleSpec = { "zero", WAVE_DC,   0.0f, 50.0f, 0, 20, 3 };
+    Waveform load(loadSpec, COUNTS_PER_AMP, ADC_MIDPOINT, ADC_MAX);
+    Waveform idle(idleSpec, COUNTS_PER_AMP, ADC_MIDPOINT, ADC_MAX, 2);
+    static uint16_t cycle[SAMPLE_RATE / 50];
+    const uint16_t count = SAMPLE_RATE / 50;
+    uint32_t index = 0;
+
+    OffsetTracker zero(ADC_MIDPOINT);
+    feedZero(zero, load, index, 500, cycle);
+    report("zero", "midpoint after load", zero.getMidpoint(), ADC_MIDPOINT, "cnt", 0);
+
+    Clock::time_point start = Clock::now();
+    feedZero(zero, idle, index, 3000, cycle);
+    double ns = elapsedNs(start);
+    report("zero", "OffsetTracker midpoint", zero.getMidpoint(), ADC_MIDPOINT + idleSpec.offsetCounts, "cnt", ns / (3000.0 * count));
+    report("zero", "OffsetTracker noise", zero.getNoise(), idleSpec.noiseCounts, "cnt", 0);
+
+    // Idle reading: around the nominal midpoint (phantom current), then
+    // around the learned one with the noise floor removed
+    ACS712 acs(ACS_PIN, ADC_VOLTS, ADC_MAX, ACS_MV_PER_AMP);
+    acs.setMidPoint(ADC_MIDPOINT);
+    report("zero", "idle, nominal zero", acs.mA_AC_sampling_buffer(cycle, count) / 1000.0f, 0, "A", 0);
+    acs.setMidPoint(lroundf(zero.getMidpoint()));
+    float idleSteps = acs.mA_AC_sampling_buffer(cycle, count) / acs.getmAPerStep();
+    report("zero", "idle, learned zero", zero.correct(idleSteps) / COUNTS_PER_AMP, 0, "A", 0);
+
+    // Idle THD is noise over a noise fundamental; it must read as none (-1)
+    HarmonicAnalyzer harmonics;
+    harmonics.begin(1, 1.0f);
+    harmonics.pushCycle(cycle, count, 0);
+    report("zero", "idle THD", harmonics.getTHD(), -1.0f, "%", 0);
+}
+
+// Metering cadence: the acs712 job drains the ring every METERING_DRAIN_MS,
+// released up to half a period late (its deadline) and the next one on time.
+// Nothing may be overwritten unread; the old 250 ms job period is shown for
+// comparison. Returns the number of failed checks.
+static int benchDrain() {
+    const WaveformSpec spec = { "drain", WAVE_SINE, 2.0f, 50.0f, 0, 0, 0 };
+    Waveform waveform(spec, COUNTS_PER_AMP, ADC_MIDPOINT, ADC_MAX);
+    _waveform = &waveform;
+    const uint8_t pins[] = { ACS_PIN };
+    const uint32_t periods[] = { METERING_DRAIN_MS, 250 };
+    int failures = 0;
+
+    for (uint32_t period : periods) {
+        _sourceIndex = 0;
+        ADCSampler::setSource(samplerSource);
+        ADCSampler::begin(pins, 1, SAMPLE_RATE);
+        ADCSampler::poll(); // begin() needs a first sample
+        HostShim::setTimeUs(0);
+        EnergyMeterModule::begin(ACS_PIN, 230.0f, ACS_MV_PER_AMP);
+        uint32_t before = EnergyMeterModule::getDroppedSamples();
+
+        int32_t pending = 0;
+        for (int r = 0; r < 200; r++) {
+            uint32_t gapMs = r % 2 ? period + period / 2 : period - period / 2;
+            pending += SAMPLE_RATE * gapMs / 1000;
+            while (pending > 0) pending -= ADCSampler::poll();
+            HostShim::setTimeUs(HostShim::getTimeUs() + gapMs * 1000ULL);
+            EnergyMeterModule::update();
+        }
+
+        uint32_t dropped = EnergyMeterModule::getDroppedSamples() - before;
+        char algorithm[32];
+        snprintf(algorithm, sizeof(algorithm), "dropped, every %lu ms", (unsigned long)period);
+        report("drain", algorithm, 100.0f * dropped / _sourceIndex, 0, "%", 0);
+        if (period == METERING_DRAIN_MS && dropped > 0) {
+            Serial.printf("FAIL: %lu samples dropped at the configured period\n", (unsigned long)dropped);
+            failures++;
+        }
+    }
+    _waveform = NULL;
+    return failures;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 2 && strcmp(argv[1], "--replay") == 0) {
+        return runReplay(argv[2], argc > 3 ? atof(argv[3]) : 1.0f);
+    }
+    if (argc > 2 && strcmp(argv[1], "--decode") == 0) {
+        return runDecode(argv[2]);
+    }
+
+    const char* filter = argc > 1 ? argv[1] : NULL;
+    Serial.printf("ACS712 %.0f mV/A on a %.1f V / %d count ADC: %.1f counts per A\n\n",
+        ACS_MV_PER_AMP, ADC_VOLTS, ADC_MAX, COUNTS_PER_AMP);
+    Serial.printf("%-12s %-24s %10s %10s %-3s %9s %9s\n",
+        "waveform", "algorithm", "result", "truth", "", "error", "ns/sample");
+
+    for (size_t i = 0; i < sizeof(WAVEFORMS) / sizeof(WAVEFORMS[0]); i++) {
+        if (filter && strcmp(filter, WAVEFORMS[i].name) != 0) continue;
+        benchWaveform(WAVEFORMS[i]);
+        Serial.println();
+    }
+    if (!filter || strcmp(filter, "zero") == 0) benchZero();
+
+    // Checks, not measurements: a failure fails the native run
+    int failures = 0;
+    if (!filter || strcmp(filter, "codec") == 0) failures += benchCodec();
+    if (!filter || strcmp(filter, "drain") == 0) failures += benchDrain();
+    if (!filter || strcmp(filter, "journal") == 0) failures += benchJournal();
+    return failures == 0 ? 0 : 1;
+}
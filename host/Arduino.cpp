@@ -0,0 +1,43 @@
+// Arduino.cpp - host shim for the native environment
+
+#include "Arduino.h"
+#include <stdarg.h>
+
+HostSerial Serial;
+
+namespace HostShim {
+    static Signal _signal = NULL;
+    static uint64_t _timeUs = 0;
+    static uint32_t _conversionUs = 10;
+    static uint32_t _reads = 0;
+
+    void setSignal(Signal signal) { _signal = signal; }
+    void setConversionTimeUs(uint32_t us) { _conversionUs = us; }
+    void setTimeUs(uint64_t us) { _timeUs = us; }
+    uint64_t getTimeUs() { return _timeUs; }
+    uint32_t getReadCount() { return _reads; }
+    void resetReadCount() { _reads = 0; }
+
+    uint16_t readADC(uint8_t pin) {
+        // Sample at the start of the conversion, then let it take its time
+        uint16_t value = _signal ? _signal(pin, _timeUs) : 0;
+        _timeUs += _conversionUs;
+        _reads++;
+        return value;
+    }
+}
+
+unsigned long micros() { return (unsigned long)HostShim::getTimeUs(); }
+unsigned long millis() { return (unsigned long)(HostShim::getTimeUs() / 1000); }
+void delay(unsigned long ms) { HostShim::setTimeUs(HostShim::getTimeUs() + ms * 1000ULL); }
+void delayMicroseconds(unsigned int us) { HostShim::setTimeUs(HostShim::getTimeUs() + us); }
+void yield() {}
+uint16_t analogRead(uint8_t pin) { return HostShim::readADC(pin); }
+
+int HostSerial::printf(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    int written = vprintf(format, args);
+    va_end(args);
+    return written;
+}
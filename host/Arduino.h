@@ -0,0 +1,64 @@
+// Arduino.h - host shim for the native environment
+//
+// Just enough of the Arduino API to build the measurement code on Linux.
+// Time is virtual: it only moves when the code reads the ADC or delays, so
+// blocking loops like ACS712::mA_AC() see a real-time signal and terminate.
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+
+using std::min;
+using std::max;
+
+#define F(x) (x)
+#define IRAM_ATTR
+#define HIGH 1
+#define LOW  0
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+unsigned long micros();
+unsigned long millis();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+uint16_t analogRead(uint8_t pin);
+
+class HostSerial {
+public:
+    int printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+    void print(const char* text) { fputs(text, stdout); }
+    void println(const char* text = "") { puts(text); }
+    int available() { return 0; }
+    int read() { return -1; }
+};
+extern HostSerial Serial;
+
+namespace HostShim {
+    // Signal seen by analogRead(): raw ADC counts of a pin at a virtual time
+    typedef uint16_t (*Signal)(uint8_t pin, uint64_t timeUs);
+
+    void setSignal(Signal signal);
+
+    // Virtual time one analogRead() takes (ESP32 Arduino analogRead is ~10 us)
+    void setConversionTimeUs(uint32_t us);
+
+    void setTimeUs(uint64_t us);
+    uint64_t getTimeUs();
+
+    // analogRead() calls since the last reset, for per-sample costs
+    uint32_t getReadCount();
+    void resetReadCount();
+
+    // Same as analogRead(), with the signature ACS712::setADC() expects
+    uint16_t readADC(uint8_t pin);
+}
+
+#endif // HOST_ARDUINO_H
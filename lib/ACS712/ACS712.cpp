@@ -138,7 +138,7 @@ float ACS712::mA_AC_sampling(float frequency, uint16_t cycles)
   for (uint16_t i = 0; i < cycles; i++)
   {
     uint16_t samples    = 0;
-    float    sumSquared = 0;
+    uint64_t sumSquared = 0;    //  integer math keeps the sample rate up
 
     uint32_t start = micros();
     while (micros() - start < period)
@@ -149,15 +149,15 @@ float ACS712::mA_AC_sampling(float frequency, uint16_t cycles)
       {
         value = (value + _analogRead(_pin))/2;
       }
-      float current = value - _midPoint;
-      sumSquared += (current * current);
+      int32_t current = value - _midPoint;
+      sumSquared += (uint32_t)(current * current);
       //  not adding noise squared might be more correct for small currents.
       //  if (abs(current) > noiseLevel)
       //  {
       //    sumSquared += (current * current);
       //  }
     }
-    sum += sqrt(sumSquared / samples);
+    sum += sqrt((float)sumSquared / samples);
   }
   float mA = sum * _mAPerStep;
   if (cycles > 1) mA /= cycles;
@@ -193,6 +193,89 @@ float ACS712::mA_DC(uint16_t cycles)
 }
 
 
+//  BUFFER BASED MEASUREMENTS
+float ACS712::mA_peak2peak_buffer(const uint16_t * samples, uint16_t count)
+{
+  if (count == 0) return 0;
+  uint16_t minimum, maximum;
+  minimum = maximum = samples[0];
+  for (uint16_t i = 1; i < count; i++)
+  {
+    uint16_t value = samples[i];
+    if (value < minimum) minimum = value;
+    else if (value > maximum) maximum = value;
+  }
+  return (maximum - minimum) * _mAPerStep;
+}
+
+
+float ACS712::mA_AC_buffer(const uint16_t * samples, uint16_t count)
+{
+  if (count == 0) return 0;
+
+  //  same algorithm as mA_AC(), one window
+  int zeroLevel = round(_noisemV/_mVperStep);
+  uint16_t zeros = 0;
+  int minimum, maximum;
+  minimum = maximum = samples[0];
+  for (uint16_t i = 0; i < count; i++)
+  {
+    int value = samples[i];
+    if (value < minimum) minimum = value;
+    else if (value > maximum) maximum = value;
+    if (abs(value - _midPoint) <= zeroLevel) zeros++;
+  }
+  int peak2peak = maximum - minimum;
+
+  float FF = _formFactor;
+  if (zeros > count * 0.025)          //  more than 2% zero's
+  {
+    float D = 1.0 - (1.0 * zeros) / count;
+    FF = sqrt(D) * _formFactor;
+  }
+  return 0.5 * peak2peak * FF * _mAPerStep;
+}
+
+
+float ACS712::mA_AC_sampling_buffer(const uint16_t * samples, uint16_t count)
+{
+  if (count == 0) return 0;
+  //  12 bit: 4095^2 * 65535 fits easily in 64 bit
+  uint64_t sumSquared = 0;
+  for (uint16_t i = 0; i < count; i++)
+  {
+    int32_t current = (int32_t)samples[i] - _midPoint;
+    sumSquared += (uint32_t)(current * current);
+  }
+  return sqrt((float)sumSquared / count) * _mAPerStep;
+}
+
+
+float ACS712::mA_DC_buffer(const uint16_t * samples, uint16_t count)
+{
+  if (count == 0) return 0;
+  int32_t sum = 0;
+  for (uint16_t i = 0; i < count; i++)
+  {
+    sum += (int32_t)samples[i] - _midPoint;
+  }
+  return sum * _mAPerStep / count;
+}
+
+
+float ACS712::zeroRatio_buffer(const uint16_t * samples, uint16_t count)
+{
+  if (count == 0) return 0;
+  int zeroLevel = round(_noisemV/_mVperStep);
+  uint16_t zeros = 0;
+  for (uint16_t i = 0; i < count; i++)
+  {
+    if (abs((int)samples[i] - _midPoint) <= zeroLevel) zeros++;
+  }
+  return (1.0 * zeros) / count;
+}
+
+
 //  CALIBRATION MIDPOINT
 uint16_t ACS712::setMidPoint(uint16_t midPoint)
 {
@@ -70,6 +70,20 @@ class ACS712
     float    mA_DC(uint16_t cycles = 1);
 
 
+    //  BUFFER BASED MEASUREMENTS
+    //  work on raw ADC samples that were already acquired, e.g. from a
+    //  DMA ring or a replay file; no blocking, no acquisition.
+    //  integer math per sample, the mA scale factor is applied once.
+    //  noise suppression is not applied, filter the buffer upstream.
+    //  count should cover whole periods for the AC variants.
+    float    mA_peak2peak_buffer(const uint16_t * samples, uint16_t count);
+    float    mA_AC_buffer(const uint16_t * samples, uint16_t count);
+    float    mA_AC_sampling_buffer(const uint16_t * samples, uint16_t count);
+    float    mA_DC_buffer(const uint16_t * samples, uint16_t count);
+    //  fraction (0.0 .. 1.0) of samples within the noise level of midPoint
+    float    zeroRatio_buffer(const uint16_t * samples, uint16_t count);
+
+
     //  midPoint functions
     //  set reference point (raw ADC) for both DC and AC
     uint16_t setMidPoint(uint16_t midPoint);
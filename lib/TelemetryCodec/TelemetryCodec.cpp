@@ -0,0 +1,337 @@
+// TelemetryCodec.cpp
+
+#include "TelemetryCodec.h"
+#include <math.h>
+#include <string.h>
+
+#define CODEC_NO_WINDOW 0xFF // No XOR stored yet, '10' is not available
+
+static const uint8_t MAGIC[2] = { 'T', 'C' };
+
+static uint32_t floatBits(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static float bitsFloat(uint32_t bits) {
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static void resetColumn(TelemetryCodecColumn& column, uint8_t decimals) {
+    column.previous = 0;
+    column.leading = CODEC_NO_WINDOW;
+    column.trailing = 0;
+    column.decimals = decimals;
+    column.scale = powf(10.0f, decimals);
+}
+
+// Delta-of-delta classes: prefix, prefix length, payload bits, bias
+struct DeltaClass {
+    uint8_t prefix;
+    uint8_t prefixBits;
+    uint8_t bits;
+    int32_t bias;
+};
+
+static const DeltaClass DELTA_CLASSES[] = {
+    { 0x2, 2, 7,  63 },   // '10'
+    { 0x6, 3, 9,  255 },  // '110'
+    { 0xE, 4, 12, 2047 }, // '1110'
+};
+
+// --- Encoder ---
+
+TelemetryEncoder::TelemetryEncoder()
+    : _buffer(NULL), _capacity(0), _bitPosition(0), _rowsOffset(0), _overflow(false),
+      _rows(0), _columnCount(0), _lastTimestamp(0), _lastDelta(0) {
+}
+
+void TelemetryEncoder::writeBits(uint32_t value, uint8_t bits) {
+    for (int8_t b = bits - 1; b >= 0; b--) {
+        size_t byte = _bitPosition >> 3;
+        if (byte >= _capacity) {
+            _overflow = true;
+            return;
+        }
+        uint8_t mask = 0x80 >> (_bitPosition & 7);
+        if ((value >> b) & 1) {
+            _buffer[byte] |= mask;
+        } else {
+            _buffer[byte] &= ~mask;
+        }
+        _bitPosition++;
+    }
+}
+
+bool TelemetryEncoder::begin(uint8_t* buffer, size_t capacity, uint32_t sequence, uint32_t t0, uint32_t unixStart,
+                             const char* const* names, const uint8_t* decimals, uint8_t columns) {
+    _buffer = buffer;
+    _capacity = capacity;
+    _bitPosition = 0;
+    _overflow = false;
+    _rows = 0;
+    _columnCount = 0;
+    _lastTimestamp = t0;
+    _lastDelta = 0;
+    if (columns > TELEMETRY_CODEC_MAX_COLUMNS) return false;
+
+    // Varints are LEB128: 7 bits per byte, low bits first
+    uint32_t header[3] = { sequence, t0, unixStart };
+    writeBits(MAGIC[0], 8);
+    writeBits(MAGIC[1], 8);
+    writeBits(TELEMETRY_CODEC_VERSION, 8);
+    for (uint8_t i = 0; i < 3; i++) {
+        uint32_t value = header[i];
+        do {
+            uint8_t byte = value & 0x7F;
+            value >>= 7;
+            writeBits(byte | (value ? 0x80 : 0), 8);
+        } while (value);
+    }
+    writeBits(columns, 8); // < 128, a one-byte varint
+    for (uint8_t c = 0; c < columns; c++) {
+        size_t length = strlen(names[c]);
+        if (length > 127) return false;
+        writeBits(decimals[c], 8);
+        writeBits(length, 8);
+        for (size_t i = 0; i < length; i++) writeBits((uint8_t)names[c][i], 8);
+        resetColumn(_columns[c], decimals[c]);
+    }
+    _rowsOffset = _bitPosition >> 3;
+    writeBits(0, 16);
+    _columnCount = columns;
+    return !_overflow;
+}
+
+void TelemetryEncoder::writeTimestamp(uint32_t timestampMs) {
+    uint32_t delta = timestampMs - _lastTimestamp;
+    int32_t deltaOfDelta = (int32_t)(delta - _lastDelta);
+    _lastTimestamp = timestampMs;
+    _lastDelta = delta;
+
+    if (deltaOfDelta == 0) {
+        writeBits(0, 1);
+        return;
+    }
+    for (const DeltaClass& range : DELTA_CLASSES) {
+        if (deltaOfDelta >= -range.bias && deltaOfDelta <= range.bias + 1) {
+            writeBits(range.prefix, range.prefixBits);
+            writeBits((uint32_t)(deltaOfDelta + range.bias), range.bits);
+            return;
+        }
+    }
+    writeBits(0xF, 4);
+    writeBits(delta, 32);
+}
+
+void TelemetryEncoder::writeValue(TelemetryCodecColumn& column, float value) {
+    uint32_t bits = floatBits(roundf(value * column.scale));
+    uint32_t xored = bits ^ column.previous;
+    column.previous = bits;
+
+    if (xored == 0) {
+        writeBits(0, 1);
+        return;
+    }
+    uint8_t leading = __builtin_clz(xored);
+    uint8_t trailing = __builtin_ctz(xored);
+
+    if (column.leading != CODEC_NO_WINDOW && leading >= column.leading && trailing >= column.trailing) {
+        writeBits(0x2, 2);
+        writeBits(xored >> column.trailing, 32 - column.leading - column.trailing);
+        return;
+    }
+    uint8_t length = 32 - leading - trailing;
+    writeBits(0x3, 2);
+    writeBits(leading, 5);
+    writeBits(length - 1, 5);
+    writeBits(xored >> trailing, length);
+    column.leading = leading;
+    column.trailing = trailing;
+}
+
+bool TelemetryEncoder::addRow(uint32_t timestampMs, const float* values) {
+    if (_buffer == NULL || _rows == 0xFFFF) return false;
+
+    // Keep the state so a row that does not fit can be taken back
+    size_t bitPosition = _bitPosition;
+    uint32_t lastTimestamp = _lastTimestamp;
+    uint32_t lastDelta = _lastDelta;
+    TelemetryCodecColumn columns[TELEMETRY_CODEC_MAX_COLUMNS];
+    memcpy(columns, _columns, sizeof(TelemetryCodecColumn) * _columnCount);
+
+    writeTimestamp(timestampMs);
+    for (uint8_t c = 0; c < _columnCount; c++) {
+        if (_rows == 0) {
+            uint32_t bits = floatBits(roundf(values[c] * _columns[c].scale));
+            writeBits(bits, 32);
+            _columns[c].previous = bits;
+        } else {
+            writeValue(_columns[c], values[c]);
+        }
+    }
+
+    if (_overflow) {
+        _overflow = false;
+        _bitPosition = bitPosition;
+        _lastTimestamp = lastTimestamp;
+        _lastDelta = lastDelta;
+        memcpy(_columns, columns, sizeof(TelemetryCodecColumn) * _columnCount);
+        return false;
+    }
+    _rows++;
+    return true;
+}
+
+size_t TelemetryEncoder::finish() {
+    if (_buffer == NULL) return 0;
+    while (_bitPosition & 7) writeBits(0, 1);
+    _buffer[_rowsOffset] = _rows & 0xFF;
+    _buffer[_rowsOffset + 1] = _rows >> 8;
+    return size();
+}
+
+// --- Decoder ---
+
+TelemetryDecoder::TelemetryDecoder()
+    : _data(NULL), _length(0), _bitPosition(0), _version(0), _sequence(0), _t0(0), _unixStart(0),
+      _rows(0), _rowIndex(0), _columnCount(0), _lastTimestamp(0), _lastDelta(0) {
+}
+
+bool TelemetryDecoder::readBits(uint8_t bits, uint32_t& value) {
+    if (_bitPosition + bits > _length * 8) return false;
+    value = 0;
+    for (uint8_t b = 0; b < bits; b++) {
+        uint8_t bit = (_data[_bitPosition >> 3] >> (7 - (_bitPosition & 7))) & 1;
+        value = (value << 1) | bit;
+        _bitPosition++;
+    }
+    return true;
+}
+
+bool TelemetryDecoder::begin(const uint8_t* data, size_t length) {
+    _data = data;
+    _length = length;
+    _bitPosition = 0;
+    _rows = _rowIndex = 0;
+    _columnCount = 0;
+
+    uint32_t byte;
+    if (!readBits(8, byte) || byte != MAGIC[0]) return false;
+    if (!readBits(8, byte) || byte != MAGIC[1]) return false;
+    if (!readBits(8, byte) || byte != TELEMETRY_CODEC_VERSION) return false;
+    _version = byte;
+
+    uint32_t* header[3] = { &_sequence, &_t0, &_unixStart };
+    for (uint8_t i = 0; i < 3; i++) {
+        uint32_t value = 0;
+        uint8_t shift = 0;
+        do {
+            if (shift > 28 || !readBits(8, byte)) return false;
+            value |= (byte & 0x7F) << shift;
+            shift += 7;
+        } while (byte & 0x80);
+        *header[i] = value;
+    }
+
+    uint32_t columns;
+    if (!readBits(8, columns) || columns > TELEMETRY_CODEC_MAX_COLUMNS) return false;
+    for (uint8_t c = 0; c < columns; c++) {
+        uint32_t decimals, nameLength;
+        if (!readBits(8, decimals) || !readBits(8, nameLength) || nameLength > 127) return false;
+        _nameOffsets[c] = _bitPosition >> 3;
+        _nameLengths[c] = nameLength;
+        if (_nameOffsets[c] + nameLength > _length) return false;
+        _bitPosition += nameLength * 8;
+        resetColumn(_columns[c], decimals);
+    }
+
+    uint32_t low, high;
+    if (!readBits(8, low) || !readBits(8, high)) return false;
+    _rows = low | (high << 8);
+    _columnCount = columns;
+    _lastTimestamp = _t0;
+    _lastDelta = 0;
+    return true;
+}
+
+bool TelemetryDecoder::getColumnName(uint8_t column, char* out, size_t size) const {
+    if (column >= _columnCount || size == 0) return false;
+    size_t length = _nameLengths[column] < size - 1 ? _nameLengths[column] : size - 1;
+    memcpy(out, _data + _nameOffsets[column], length);
+    out[length] = '\0';
+    return true;
+}
+
+bool TelemetryDecoder::readTimestamp(uint32_t& timestampMs) {
+    uint32_t bit;
+    uint8_t ones = 0;
+    while (ones < 4) {
+        if (!readBits(1, bit)) return false;
+        if (bit == 0) break;
+        ones++;
+    }
+
+    uint32_t delta;
+    if (ones == 0) {
+        delta = _lastDelta;
+    } else if (ones < 4) {
+        const DeltaClass& range = DELTA_CLASSES[ones - 1];
+        uint32_t payload;
+        if (!readBits(range.bits, payload)) return false;
+        delta = _lastDelta + (uint32_t)((int32_t)payload - range.bias);
+    } else {
+        if (!readBits(32, delta)) return false;
+    }
+    _lastDelta = delta;
+    _lastTimestamp += delta;
+    timestampMs = _lastTimestamp;
+    return true;
+}
+
+bool TelemetryDecoder::readValue(TelemetryCodecColumn& column, float& value) {
+    uint32_t control, xored = 0;
+    if (!readBits(1, control)) return false;
+    if (control == 1) {
+        if (!readBits(1, control)) return false;
+        if (control == 0) {
+            if (column.leading == CODEC_NO_WINDOW) return false;
+            uint8_t length = 32 - column.leading - column.trailing;
+            if (!readBits(length, xored)) return false;
+            xored <<= column.trailing;
+        } else {
+            uint32_t leading, length;
+            if (!readBits(5, leading) || !readBits(5, length)) return false;
+            length += 1;
+            if (leading + length > 32) return false;
+            if (!readBits(length, xored)) return false;
+            column.leading = leading;
+            column.trailing = 32 - leading - length;
+            xored <<= column.trailing;
+        }
+    }
+    column.previous ^= xored;
+    value = bitsFloat(column.previous) / column.scale;
+    return true;
+}
+
+bool TelemetryDecoder::next(uint32_t& timestampMs, float* values) {
+    if (_data == NULL || _rowIndex >= _rows) return false;
+
+    if (!readTimestamp(timestampMs)) return false;
+    if (_rowIndex == 0) {
+        for (uint8_t c = 0; c < _columnCount; c++) {
+            if (!readBits(32, _columns[c].previous)) return false;
+            values[c] = bitsFloat(_columns[c].previous) / _columns[c].scale;
+        }
+    } else {
+        for (uint8_t c = 0; c < _columnCount; c++) {
+            if (!readValue(_columns[c], values[c])) return false;
+        }
+    }
+    _rowIndex++;
+    return true;
+}
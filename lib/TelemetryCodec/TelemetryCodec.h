@@ -0,0 +1,130 @@
+// TelemetryCodec.h
+//
+// Compact binary encoding for telemetry batches: delta-of-delta timestamps
+// and XOR-compressed floats in the style of Facebook's Gorilla, with varint
+// header fields. Plain C++ without Arduino dependencies, so the same files
+// are the encoder on the ESP32 and the reference decoder on a server.
+//
+// Batch layout (version 1):
+//
+//   'T' 'C'                    magic
+//   u8      version            TELEMETRY_CODEC_VERSION
+//   varint  sequence           batch counter of the sender
+//   varint  t0                 timestamp of the first row (ms, sender uptime)
+//   varint  unixStart          Unix seconds of t0, 0 when the clock was not set
+//   varint  columns
+//   columns x { u8 decimals, varint nameLength, name bytes }
+//   u16 LE  rows
+//   bit stream, MSB first, padded with zeros to a whole byte:
+//     per row, the timestamp delta-of-delta (ms; from t0 with a zero
+//     previous delta, so a first row at t0 costs one bit):
+//       '0'                  0
+//       '10'   + 7 bits      -63..64
+//       '110'  + 9 bits      -255..256
+//       '1110' + 12 bits     -2047..2048
+//       '1111' + 32 bits     the plain delta (gaps, clock jumps)
+//     then per column the value, quantized to round(value * 10^decimals)
+//     and kept as an IEEE float (an integer, so the low mantissa bits are
+//     zero), XORed with the previous row's value:
+//       first row            32 raw bits
+//       '0'                  same as before
+//       '10' + bits          inside the previous leading/trailing zero window
+//       '11' + 5 bits leading zeros + 5 bits (length - 1) + length bits
+
+#ifndef TELEMETRY_CODEC_H
+#define TELEMETRY_CODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define TELEMETRY_CODEC_VERSION     1
+#define TELEMETRY_CODEC_MAX_COLUMNS 24
+
+// Per-column XOR state, shared by both directions
+struct TelemetryCodecColumn {
+    uint32_t previous;  // Bits of the previous quantized value
+    uint8_t leading;    // Zero window of the last stored XOR
+    uint8_t trailing;
+    uint8_t decimals;
+    float scale;        // 10^decimals
+};
+
+class TelemetryEncoder {
+public:
+    TelemetryEncoder();
+
+    // Writes the header into buffer. names/decimals describe every row's
+    // columns; false when they do not fit or there are too many.
+    bool begin(uint8_t* buffer, size_t capacity, uint32_t sequence, uint32_t t0, uint32_t unixStart,
+               const char* const* names, const uint8_t* decimals, uint8_t columns);
+
+    // Appends one row; false, with nothing written, when it does not fit
+    bool addRow(uint32_t timestampMs, const float* values);
+
+    // Writes the row count and pads the last byte; returns the batch size
+    size_t finish();
+
+    uint16_t getRows() const { return _rows; }
+    size_t size() const { return (_bitPosition + 7) / 8; }
+
+private:
+    void writeBits(uint32_t value, uint8_t bits);
+    void writeTimestamp(uint32_t timestampMs);
+    void writeValue(TelemetryCodecColumn& column, float value);
+
+    uint8_t* _buffer;
+    size_t _capacity;
+    size_t _bitPosition;   // From the start of the buffer
+    size_t _rowsOffset;    // Byte offset of the row count
+    bool _overflow;
+    uint16_t _rows;
+    uint8_t _columnCount;
+    uint32_t _lastTimestamp;
+    uint32_t _lastDelta;
+    TelemetryCodecColumn _columns[TELEMETRY_CODEC_MAX_COLUMNS];
+};
+
+class TelemetryDecoder {
+public:
+    TelemetryDecoder();
+
+    // Parses the header; false for anything that is not a version 1 batch
+    bool begin(const uint8_t* data, size_t length);
+
+    // Next row; false after the last one or on truncated data
+    bool next(uint32_t& timestampMs, float* values);
+
+    uint8_t getVersion() const { return _version; }
+    uint32_t getSequence() const { return _sequence; }
+    uint32_t getT0() const { return _t0; }
+    uint32_t getUnixStart() const { return _unixStart; }
+    uint16_t getRows() const { return _rows; }
+    uint8_t getColumnCount() const { return _columnCount; }
+    uint8_t getDecimals(uint8_t column) const { return _columns[column].decimals; }
+
+    // Copies a column name into out (always terminated); false when out of range
+    bool getColumnName(uint8_t column, char* out, size_t size) const;
+
+private:
+    bool readBits(uint8_t bits, uint32_t& value);
+    bool readTimestamp(uint32_t& timestampMs);
+    bool readValue(TelemetryCodecColumn& column, float& value);
+
+    const uint8_t* _data;
+    size_t _length;
+    size_t _bitPosition;
+    uint8_t _version;
+    uint32_t _sequence;
+    uint32_t _t0;
+    uint32_t _unixStart;
+    uint16_t _rows;
+    uint16_t _rowIndex;
+    uint8_t _columnCount;
+    uint32_t _lastTimestamp;
+    uint32_t _lastDelta;
+    size_t _nameOffsets[TELEMETRY_CODEC_MAX_COLUMNS];
+    uint8_t _nameLengths[TELEMETRY_CODEC_MAX_COLUMNS];
+    TelemetryCodecColumn _columns[TELEMETRY_CODEC_MAX_COLUMNS];
+};
+
+#endif // TELEMETRY_CODEC_H
@@ -0,0 +1,23 @@
+# Gzips the web files in data/ before the filesystem image is built.
+# ESPAsyncWebServer serves "file.gz" with Content-Encoding: gzip when it exists.
+import gzip
+import os
+import shutil
+
+Import("env")
+
+COMPRESSIBLE = (".html", ".css", ".js", ".json", ".svg")
+
+
+def gzip_data(source, target, env):
+    data_dir = env.subst("$PROJECT_DATA_DIR")
+    for name in os.listdir(data_dir):
+        path = os.path.join(data_dir, name)
+        if not name.endswith(COMPRESSIBLE) or not os.path.isfile(path):
+            continue
+        with open(path, "rb") as src, gzip.open(path + ".gz", "wb", compresslevel=9) as dst:
+            shutil.copyfileobj(src, dst)
+        print("Compressed %s" % name)
+
+
+env.AddPreAction("$BUILD_DIR/littlefs.bin", gzip_data)
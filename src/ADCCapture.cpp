@@ -0,0 +1,236 @@
+// ADCCapture.cpp
+
+#include "ADCCapture.h"
+
+#if defined(ARDUINO)
+#include <LittleFS.h>
+#include <time.h>
+#include "Checksum.h"
+
+#define ADC_CAPTURE_PATH "/capture.adc"
+
+namespace ADCCapture {
+    static Print* _out = NULL;
+    static File _file;
+    static ADCCaptureHeader _header;
+    static uint32_t _cursor = 0;
+    static uint32_t _endFrame = 0;     // 0 = no limit
+    static uint32_t _framesWritten = 0;
+    static uint32_t _gaps = 0;
+    static uint32_t _serialBaud = 0;   // Baud rate to restore, 0 for file captures
+    static uint16_t _samples[ADC_CAPTURE_BLOCK_FRAMES * ADC_SAMPLER_MAX_CHANNELS];
+
+    // Bytes formatted but not yet taken by the output (header or one block)
+    static uint8_t _pending[sizeof(ADCCaptureBlock) + sizeof(_samples)];
+    static size_t _pendingLength = 0;
+    static size_t _pendingSent = 0;
+
+    // Oldest head over all channels: frames every channel has delivered
+    static uint32_t completeHead() {
+        uint32_t head = ADCSampler::head(_header.pins[0]);
+        for (uint8_t c = 1; c < _header.channelCount; c++) {
+            uint32_t h = ADCSampler::head(_header.pins[c]);
+            if ((int32_t)(h - head) < 0) head = h;
+        }
+        return head;
+    }
+
+    static bool isSampled(uint8_t pin) {
+        for (uint8_t c = 0; c < ADCSampler::getChannelCount(); c++) {
+            if (ADCSampler::getPin(c) == pin) return true;
+        }
+        return false;
+    }
+
+    // Hands pending bytes to the output; the serial port only gets what its
+    // TX buffer has room for. True when nothing is left.
+    static bool flushPending() {
+        size_t length = _pendingLength - _pendingSent;
+        if (_serialBaud != 0) {
+            int room = Serial.availableForWrite();
+            if (room <= 0) return length == 0;
+            if ((size_t)room < length) length = room;
+        }
+        _pendingSent += _out->write(_pending + _pendingSent, length);
+        return _pendingSent == _pendingLength;
+    }
+
+    static void queue(const void* data, size_t length) {
+        memcpy(_pending + _pendingLength, data, length);
+        _pendingLength += length;
+    }
+
+    static bool start(Print* out, uint32_t seconds, const uint8_t* pins, uint8_t pinCount) {
+        if (_out != NULL || !ADCSampler::isRunning()) return false;
+
+        memset(&_header, 0, sizeof(_header));
+        _header.magic = ADC_CAPTURE_MAGIC;
+        _header.version = ADC_CAPTURE_VERSION;
+        _header.sampleRateHz = ADCSampler::getSampleRate();
+        time_t now = time(NULL);
+        _header.startUnixTime = now > 1600000000 ? now : 0;
+        if (pinCount == 0) {
+            _header.channelCount = ADCSampler::getChannelCount();
+            for (uint8_t c = 0; c < _header.channelCount; c++) {
+                _header.pins[c] = ADCSampler::getPin(c);
+            }
+        } else {
+            if (pinCount > ADC_SAMPLER_MAX_CHANNELS) return false;
+            for (uint8_t c = 0; c < pinCount; c++) {
+                if (!isSampled(pins[c])) {
+                    Serial.printf("⚠️ GPIO %d is not sampled.\n", pins[c]);
+                    return false;
+                }
+                _header.pins[c] = pins[c];
+            }
+            _header.channelCount = pinCount;
+        }
+
+        // Log first, so a serial capture starts with the header
+        Serial.printf("🎙️ ADC capture started: %d channel(s) @ %lu Hz\n",
+            _header.channelCount, (unsigned long)_header.sampleRateHz);
+        Serial.flush();
+
+        _out = out;
+        _pendingLength = _pendingSent = 0;
+        queue(&_header, sizeof(_header));
+        _cursor = completeHead();
+        _endFrame = seconds ? _cursor + seconds * _header.sampleRateHz : 0;
+        _framesWritten = 0;
+        _gaps = 0;
+        return true;
+    }
+
+    bool startFile(const char* path, uint32_t seconds, const uint8_t* pins, uint8_t pinCount) {
+        if (_out != NULL) return false;
+        _file = LittleFS.open(path, "w");
+        if (!_file) {
+            Serial.printf("⚠️ Cannot create %s\n", path);
+            return false;
+        }
+        _serialBaud = 0;
+        if (!start(&_file, seconds, pins, pinCount)) {
+            _file.close();
+            return false;
+        }
+        return true;
+    }
+
+    bool startSerial(uint32_t seconds, const uint8_t* pins, uint8_t pinCount) {
+        if (_out != NULL) return false;
+        Serial.printf("🎙️ Serial capture at %lu baud, switch the terminal over.\n", (unsigned long)ADC_CAPTURE_SERIAL_BAUD);
+        Serial.flush();
+        _serialBaud = Serial.baudRate();
+        Serial.updateBaudRate(ADC_CAPTURE_SERIAL_BAUD);
+        if (!start(&Serial, seconds, pins, pinCount)) {
+            Serial.updateBaudRate(_serialBaud);
+            _serialBaud = 0;
+            return false;
+        }
+        return true;
+    }
+
+    void stop() {
+        if (_out == NULL) return;
+        if (_out == &_file) _file.close();
+        _out = NULL;
+        if (_serialBaud != 0) {
+            Serial.flush();
+            Serial.updateBaudRate(_serialBaud);
+            _serialBaud = 0;
+        }
+        Serial.printf("🎙️ ADC capture stopped: %lu frames, %lu gap(s)\n",
+            (unsigned long)_framesWritten, (unsigned long)_gaps);
+    }
+
+    bool isActive() {
+        return _out != NULL;
+    }
+
+    static void writeBlock(uint32_t frames) {
+        const uint8_t channels = _header.channelCount;
+        uint32_t rate = _header.sampleRateHz;
+        uint32_t behind = ADCSampler::head(_header.pins[0]) - _cursor;
+
+        ADCCaptureBlock block;
+        block.firstFrame = _cursor;
+        block.timestampUs = micros() - (uint32_t)((uint64_t)behind * 1000000ULL / rate);
+        block.frameCount = frames;
+        block.sync = ADC_CAPTURE_BLOCK_SYNC;
+
+        static uint16_t channel[ADC_CAPTURE_BLOCK_FRAMES];
+        for (uint8_t c = 0; c < channels; c++) {
+            uint32_t cursor = _cursor;
+            ADCSampler::read(_header.pins[c], cursor, channel, frames);
+            for (uint32_t f = 0; f < frames; f++) _samples[f * channels + c] = channel[f];
+        }
+        size_t bytes = frames * channels * sizeof(uint16_t);
+        block.crc = Checksum::crc32(_samples, bytes);
+
+        _pendingLength = _pendingSent = 0;
+        queue(&block, sizeof(block));
+        queue(_samples, bytes);
+        flushPending();
+        _cursor += frames;
+        _framesWritten += frames;
+    }
+
+    void loop() {
+        if (_out == NULL) return;
+        if (!flushPending()) return; // The port is busy; the ring keeps filling meanwhile
+
+        uint32_t head = completeHead();
+        if (head - _cursor > ADC_SAMPLER_RING_SIZE - ADC_CAPTURE_BLOCK_FRAMES) {
+            // The output stalled longer than the ring lasts: skip ahead, leave a gap
+            _cursor = head - ADC_SAMPLER_RING_SIZE / 2;
+            _gaps++;
+        }
+        bool finished = _endFrame != 0 && (int32_t)(head - _endFrame) >= 0;
+        if (finished) head = _endFrame;
+
+        while (head - _cursor >= ADC_CAPTURE_BLOCK_FRAMES) {
+            writeBlock(ADC_CAPTURE_BLOCK_FRAMES);
+            if (_pendingSent < _pendingLength) return;
+        }
+        if (finished) {
+            if ((int32_t)(head - _cursor) > 0) {
+                writeBlock(head - _cursor);
+                if (_pendingSent < _pendingLength) return; // Stops once it is out
+            }
+            stop();
+        }
+    }
+
+    bool handleCommand(const char* line) {
+        if (strncmp(line, "capture", 7) != 0) return false;
+
+        char mode[8] = "";
+        unsigned long seconds = 10;
+        int consumed = 0;
+        sscanf(line + 7, "%7s %lu%n", mode, &seconds, &consumed);
+
+        // Optional pins after the duration; the serial port cannot carry all of them
+        uint8_t pins[ADC_SAMPLER_MAX_CHANNELS];
+        uint8_t pinCount = 0;
+        const char* rest = consumed > 0 ? line + 7 + consumed : "";
+        char* end;
+        for (long pin = strtol(rest, &end, 10); end != rest && pinCount < ADC_SAMPLER_MAX_CHANNELS; pin = strtol(rest, &end, 10)) {
+            pins[pinCount++] = (uint8_t)pin;
+            rest = end;
+        }
+
+        if (strcmp(mode, "stop") == 0) {
+            stop();
+        } else if (strcmp(mode, "file") == 0) {
+            if (startFile(ADC_CAPTURE_PATH, seconds, pins, pinCount)) {
+                Serial.printf("   Writing %s for %lu s\n", ADC_CAPTURE_PATH, seconds);
+            }
+        } else if (strcmp(mode, "serial") == 0) {
+            startSerial(seconds, pins, pinCount);
+        } else {
+            Serial.println("   Usage: capture file|serial [seconds] [pin...] | capture stop");
+        }
+        return true;
+    }
+}
+#endif
@@ -0,0 +1,62 @@
+// ADCCapture.h
+
+#ifndef ADC_CAPTURE_H
+#define ADC_CAPTURE_H
+
+#include <Arduino.h>
+#include "ADCSampler.h"
+
+// --- Capture file format (little endian) ---
+// One header, then blocks of interleaved raw samples in sampler pin order.
+// Sample i of a block was taken at timestampUs + i * 1e6 / sampleRateHz;
+// a jump in firstFrame marks samples lost while the writer fell behind.
+#define ADC_CAPTURE_MAGIC        0x43434441 // "ADCC"
+#define ADC_CAPTURE_VERSION      1
+#define ADC_CAPTURE_BLOCK_SYNC   0xB10C
+#define ADC_CAPTURE_BLOCK_FRAMES 256
+#define ADC_CAPTURE_SERIAL_BAUD  921600 // ~92 KB/s; 3 channels at 10 kHz need ~61 KB/s
+#define ADC_CAPTURE_TX_BUFFER    4096   // Serial TX buffer for main to set before Serial.begin()
+
+struct ADCCaptureHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint8_t channelCount;
+    uint8_t reserved;
+    uint32_t sampleRateHz;
+    uint32_t startUnixTime;   // 0 when the clock was not set
+    uint8_t pins[ADC_SAMPLER_MAX_CHANNELS]; // Channel IDs (GPIO) in frame order
+};
+
+struct ADCCaptureBlock {
+    uint32_t firstFrame;      // Sampler frame index of the first frame
+    uint32_t timestampUs;     // micros() of the first frame
+    uint16_t frameCount;
+    uint16_t sync;            // ADC_CAPTURE_BLOCK_SYNC, to resync serial streams
+    uint32_t crc;             // CRC-32 of the samples
+    // uint16_t samples[frameCount * channelCount] follow
+};
+
+#if defined(ARDUINO)
+namespace ADCCapture {
+    // Records the given sampler pins (all of them when pinCount is 0) to a
+    // LittleFS file or the serial port for `seconds` (0 = until stop()).
+    //
+    // Serial mode is lossy: the port switches to ADC_CAPTURE_SERIAL_BAUD for
+    // the capture (and back afterwards) and loop() only writes what the TX
+    // buffer takes, so it never blocks; whatever the port cannot keep up
+    // with becomes gaps. Log lines of other tasks land in the binary stream;
+    // the block sync word and CRC let readers skip them.
+    bool startFile(const char* path, uint32_t seconds, const uint8_t* pins = NULL, uint8_t pinCount = 0);
+    bool startSerial(uint32_t seconds, const uint8_t* pins = NULL, uint8_t pinCount = 0);
+    void stop();
+    bool isActive();
+
+    // Moves captured samples to the output; run it at least every ~100 ms
+    void loop();
+
+    // "capture file|serial [seconds] [pin...]", "capture stop"; false if not a capture command
+    bool handleCommand(const char* line);
+}
+#endif
+
+#endif // ADC_CAPTURE_H
@@ -0,0 +1,196 @@
+// ADCReplay.cpp
+
+#include "ADCReplay.h"
+#include "Checksum.h"
+
+#if defined(ARDUINO)
+#include <LittleFS.h>
+#else
+#include <stdio.h>
+#endif
+
+namespace ADCReplay {
+    static ADCCaptureHeader _header;
+    static uint16_t _samples[ADC_CAPTURE_BLOCK_FRAMES * ADC_SAMPLER_MAX_CHANNELS];
+    static uint16_t _blockFrames = 0;
+    static uint16_t _blockPosition = 0;
+    static int8_t _map[ADC_SAMPLER_MAX_CHANNELS]; // Output channel -> file channel
+    static uint8_t _outputChannels = 0;
+    static uint32_t _dataStart = 0;
+    static uint32_t _expectedFrame = 0;
+    static bool _hasBlock = false;
+    static bool _open = false;
+    static bool _finished = false;
+    static bool _paced = false;
+    static bool _repeat = false;
+    static uint32_t _startUs = 0;
+    static uint64_t _replayed = 0;
+    static uint32_t _badBlocks = 0;
+    static uint32_t _gaps = 0;
+
+    // --- File access: LittleFS on the device, stdio on Linux ---
+#if defined(ARDUINO)
+    static File _file;
+    static bool openFile(const char* path) {
+        if (!LittleFS.exists(path)) return false;
+        _file = LittleFS.open(path, "r");
+        return (bool)_file;
+    }
+    static void closeFile() { _file.close(); }
+    static size_t readBytes(void* data, size_t length) { return _file.read((uint8_t*)data, length); }
+    static void seekTo(uint32_t position) { _file.seek(position); }
+    static uint32_t position() { return _file.position(); }
+#else
+    static FILE* _file = NULL;
+    static bool openFile(const char* path) { _file = fopen(path, "rb"); return _file != NULL; }
+    static void closeFile() { if (_file) fclose(_file); _file = NULL; }
+    static size_t readBytes(void* data, size_t length) { return fread(data, 1, length, _file); }
+    static void seekTo(uint32_t position) { fseek(_file, position, SEEK_SET); }
+    static uint32_t position() { return ftell(_file); }
+#endif
+
+    // Skips anything before the header (e.g. log lines of a serial capture)
+    static bool findHeader() {
+        uint32_t window = 0;
+        uint8_t byte;
+        while (readBytes(&byte, 1) == 1) {
+            window = (window >> 8) | ((uint32_t)byte << 24);
+            if (window != ADC_CAPTURE_MAGIC) continue;
+
+            _header.magic = window;
+            uint8_t* rest = (uint8_t*)&_header + sizeof(_header.magic);
+            if (readBytes(rest, sizeof(_header) - sizeof(_header.magic)) != sizeof(_header) - sizeof(_header.magic)) return false;
+            return _header.version == ADC_CAPTURE_VERSION
+                && _header.channelCount > 0 && _header.channelCount <= ADC_SAMPLER_MAX_CHANNELS
+                && _header.sampleRateHz > 0;
+        }
+        return false;
+    }
+
+    // Loads the next valid block; on a bad one moves on byte by byte
+    static bool nextBlock() {
+        bool resyncing = false;
+        for (;;) {
+            uint32_t start = position();
+            ADCCaptureBlock block;
+            if (readBytes(&block, sizeof(block)) != sizeof(block)) return false;
+
+            size_t bytes = block.frameCount * _header.channelCount * sizeof(uint16_t);
+            bool valid = block.sync == ADC_CAPTURE_BLOCK_SYNC
+                && block.frameCount > 0 && block.frameCount <= ADC_CAPTURE_BLOCK_FRAMES
+                && readBytes(_samples, bytes) == bytes
+                && Checksum::crc32(_samples, bytes) == block.crc;
+            if (!valid) {
+                if (!resyncing) _badBlocks++;
+                resyncing = true;
+                seekTo(start + 1);
+                continue;
+            }
+
+            if (_hasBlock && block.firstFrame != _expectedFrame) _gaps++;
+            _expectedFrame = block.firstFrame + block.frameCount;
+            _hasBlock = true;
+            _blockFrames = block.frameCount;
+            _blockPosition = 0;
+            return true;
+        }
+    }
+
+    bool begin(const char* path, bool paced, bool repeat) {
+        end();
+        if (!openFile(path)) return false;
+        if (!findHeader()) {
+            Serial.printf("⚠️ %s is not an ADC capture.\n", path);
+            closeFile();
+            return false;
+        }
+
+        _dataStart = position();
+        _open = true;
+        _paced = paced;
+        _repeat = repeat;
+        _finished = false;
+        _hasBlock = false;
+        _blockFrames = _blockPosition = 0;
+        _replayed = 0;
+        _badBlocks = _gaps = 0;
+        _startUs = micros();
+
+        _outputChannels = _header.channelCount;
+        for (uint8_t c = 0; c < _outputChannels; c++) _map[c] = c;
+
+        Serial.printf("⏯️ Replaying %s: %d channel(s) @ %lu Hz\n",
+            path, _header.channelCount, (unsigned long)_header.sampleRateHz);
+        return true;
+    }
+
+    void end() {
+        if (_open) closeFile();
+        _open = false;
+        _finished = true;
+    }
+
+    void mapPins(const uint8_t* pins, uint8_t pinCount) {
+        _outputChannels = min(pinCount, (uint8_t)ADC_SAMPLER_MAX_CHANNELS);
+        for (uint8_t c = 0; c < _outputChannels; c++) {
+            _map[c] = -1;
+            for (uint8_t f = 0; f < _header.channelCount; f++) {
+                if (_header.pins[f] == pins[c]) _map[c] = f;
+            }
+        }
+    }
+
+    size_t source(uint16_t* frames, size_t maxFrames) {
+        if (!_open || _finished) return 0;
+
+        if (_paced) {
+            uint64_t due = (uint64_t)(uint32_t)(micros() - _startUs) * _header.sampleRateHz / 1000000ULL;
+            // Wraps after ~71 minutes; restart the pacing clock instead
+            if (due < _replayed) { _startUs = micros(); _replayed = 0; due = 0; }
+            if (due - _replayed < maxFrames) maxFrames = due - _replayed;
+        }
+
+        size_t count = 0;
+        while (count < maxFrames) {
+            if (_blockPosition >= _blockFrames && !nextBlock()) {
+                if (!_repeat || !_hasBlock) {
+                    _finished = true;
+                    break;
+                }
+                seekTo(_dataStart);
+                _hasBlock = false; // Restarting is not a gap
+                continue;
+            }
+
+            const uint16_t* in = &_samples[_blockPosition * _header.channelCount];
+            uint16_t* out = &frames[count * _outputChannels];
+            for (uint8_t c = 0; c < _outputChannels; c++) {
+                out[c] = _map[c] >= 0 ? in[_map[c]] : 0;
+            }
+            _blockPosition++;
+            count++;
+        }
+        _replayed += count;
+        return count;
+    }
+
+    const ADCCaptureHeader& getHeader() {
+        return _header;
+    }
+
+    bool isFinished() {
+        return _finished;
+    }
+
+    uint32_t getFramesReplayed() {
+        return _replayed;
+    }
+
+    uint32_t getBadBlocks() {
+        return _badBlocks;
+    }
+
+    uint32_t getGaps() {
+        return _gaps;
+    }
+}
@@ -0,0 +1,32 @@
+// ADCReplay.h
+
+#ifndef ADC_REPLAY_H
+#define ADC_REPLAY_H
+
+#include <Arduino.h>
+#include "ADCCapture.h"
+
+// Feeds an ADCCapture file back through ADCSampler, on the device (from
+// LittleFS) or in the native build (any path), so the measurement code sees
+// the recorded field signal sample for sample.
+namespace ADCReplay {
+    // paced: deliver at the recorded rate (device); unpaced runs as fast as
+    // polled (host). repeat: start over at the end of the file.
+    bool begin(const char* path, bool paced, bool repeat);
+    void end();
+
+    // Reorders the recorded channels to the sampler pin order; pins that
+    // are not in the file read 0. begin() maps the file order as is.
+    void mapPins(const uint8_t* pins, uint8_t pinCount);
+
+    // ADCSampler::SampleSource
+    size_t source(uint16_t* frames, size_t maxFrames);
+
+    const ADCCaptureHeader& getHeader();
+    bool isFinished();
+    uint32_t getFramesReplayed();
+    uint32_t getBadBlocks();  // Skipped for a bad CRC or sync word
+    uint32_t getGaps();       // Capture lost samples here
+}
+
+#endif // ADC_REPLAY_H
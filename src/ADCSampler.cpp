@@ -0,0 +1,234 @@
+// ADCSampler.cpp
+
+#include "ADCSampler.h"
+#include <atomic>
+
+#if defined(ESP32)
+#include <driver/adc.h>
+#endif
+
+namespace ADCSampler {
+    struct Channel {
+        uint8_t pin;
+        uint16_t samples[ADC_SAMPLER_RING_SIZE];
+        std::atomic<uint32_t> head; // Only the reader task writes this
+    };
+
+    static Channel _channels[ADC_SAMPLER_MAX_CHANNELS];
+    static uint8_t _channelCount = 0;
+    static uint32_t _sampleRate = 0;
+    static SampleSource _source = NULL;
+    static bool _running = false;
+
+    static int channelIndex(uint8_t pin) {
+        for (uint8_t i = 0; i < _channelCount; i++) {
+            if (_channels[i].pin == pin) return i;
+        }
+        return -1;
+    }
+
+#if defined(ESP32)
+    #define DMA_READ_BYTES 256 // ADC_SAMPLER_BATCH conversions per driver read
+
+    static TaskHandle_t _task = NULL;
+    static uint8_t _dmaChannel[ADC_SAMPLER_MAX_CHANNELS];
+    static uint16_t _partialFrame[ADC_SAMPLER_MAX_CHANNELS];
+    static uint32_t _partialMask = 0;
+
+    // Drains the DMA driver and rebuilds interleaved frames from the tagged conversions
+    static size_t dmaSource(uint16_t* frames, size_t maxFrames) {
+        static uint8_t raw[DMA_READ_BYTES];
+        uint32_t length = 0;
+        size_t maxBytes = min((size_t)DMA_READ_BYTES, maxFrames * SOC_ADC_DIGI_RESULT_BYTES);
+        if (adc_digi_read_bytes(raw, maxBytes, &length, 10) != ESP_OK) return 0;
+
+        const uint32_t fullMask = (1UL << _channelCount) - 1;
+        size_t frameCount = 0;
+        for (uint32_t i = 0; i + SOC_ADC_DIGI_RESULT_BYTES <= length; i += SOC_ADC_DIGI_RESULT_BYTES) {
+            adc_digi_output_data_t* out = (adc_digi_output_data_t*)&raw[i];
+            for (uint8_t c = 0; c < _channelCount; c++) {
+                if (_dmaChannel[c] != out->type1.channel) continue;
+                _partialFrame[c] = out->type1.data;
+                _partialMask |= (1UL << c);
+                break;
+            }
+            if (_partialMask == fullMask) {
+                memcpy(&frames[frameCount * _channelCount], _partialFrame, _channelCount * sizeof(uint16_t));
+                _partialMask = 0;
+                if (++frameCount >= maxFrames) break;
+            }
+        }
+        return frameCount;
+    }
+
+    static bool startDMA() {
+        adc_digi_init_config_t initConfig = {};
+        initConfig.max_store_buf_size = 4 * DMA_READ_BYTES;
+        initConfig.conv_num_each_intr = DMA_READ_BYTES / SOC_ADC_DIGI_RESULT_BYTES;
+        adc_digi_pattern_config_t pattern[SOC_ADC_PATT_LEN_MAX] = {};
+
+        for (uint8_t c = 0; c < _channelCount; c++) {
+            int8_t channel = digitalPinToAnalogChannel(_channels[c].pin);
+            if (channel < 0 || channel > 7) {
+                Serial.printf("⚠️ ADC sampler: GPIO %d is not an ADC1 pin.\n", _channels[c].pin);
+                return false;
+            }
+            _dmaChannel[c] = channel;
+            initConfig.adc1_chan_mask |= (1UL << channel);
+            pattern[c].atten = ADC_ATTEN_DB_11;
+            pattern[c].channel = channel;
+            pattern[c].unit = 0; // ADC1
+            pattern[c].bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
+        }
+
+        adc_digi_configuration_t config = {};
+        config.conv_limit_en = true; // Required on the ESP32
+        config.conv_limit_num = 250;
+        config.pattern_num = _channelCount;
+        config.adc_pattern = pattern;
+        config.sample_freq_hz = _sampleRate * _channelCount;
+        config.conv_mode = ADC_CONV_SINGLE_UNIT_1;
+        config.format = ADC_DIGI_OUTPUT_FORMAT_TYPE1;
+
+        if (adc_digi_initialize(&initConfig) != ESP_OK) return false;
+        if (adc_digi_controller_configure(&config) != ESP_OK) return false;
+        return adc_digi_start() == ESP_OK;
+    }
+
+    static void readerTask(void*) {
+        for (;;) {
+            // The DMA source blocks inside the driver; other sources pace themselves
+            if (poll() == 0) vTaskDelay(1);
+        }
+    }
+#endif
+
+    bool begin(const uint8_t* pins, uint8_t pinCount, uint32_t sampleRateHz) {
+        if (pinCount == 0 || pinCount > ADC_SAMPLER_MAX_CHANNELS || sampleRateHz == 0) return false;
+
+        _channelCount = pinCount;
+        _sampleRate = sampleRateHz;
+        for (uint8_t c = 0; c < _channelCount; c++) {
+            _channels[c].pin = pins[c];
+            _channels[c].head.store(0);
+        }
+
+#if defined(ESP32)
+        if (_source == NULL && !startDMA()) {
+            Serial.println("⚠️ ADC DMA sampler failed to start.");
+            return false;
+        }
+        xTaskCreatePinnedToCore(readerTask, "adc_sampler", 4096, NULL, configMAX_PRIORITIES - 2, &_task, 0);
+#endif
+        _running = true;
+        Serial.printf("📈 ADC sampler running: %d channel(s) @ %lu Hz\n", _channelCount, (unsigned long)_sampleRate);
+        return true;
+    }
+
+    void setSource(SampleSource source) {
+        _source = source;
+    }
+
+    size_t poll() {
+        static uint16_t frames[ADC_SAMPLER_BATCH * ADC_SAMPLER_MAX_CHANNELS];
+        if (_channelCount == 0) return 0;
+
+        SampleSource source = _source;
+#if defined(ESP32)
+        if (source == NULL) source = dmaSource;
+#endif
+        if (source == NULL) return 0;
+
+        size_t frameCount = source(frames, ADC_SAMPLER_BATCH);
+        for (uint8_t c = 0; c < _channelCount; c++) {
+            Channel& ch = _channels[c];
+            uint32_t head = ch.head.load(std::memory_order_relaxed);
+            for (size_t f = 0; f < frameCount; f++) {
+                ch.samples[(head + f) & (ADC_SAMPLER_RING_SIZE - 1)] = frames[f * _channelCount + c];
+            }
+            // Publish the samples only after they are written
+            ch.head.store(head + frameCount, std::memory_order_release);
+        }
+        return frameCount;
+    }
+
+    bool isRunning() {
+        return _running;
+    }
+
+    uint32_t getSampleRate() {
+        return _sampleRate;
+    }
+
+    uint8_t getChannelCount() {
+        return _channelCount;
+    }
+
+    uint8_t getPin(uint8_t channel) {
+        return channel < _channelCount ? _channels[channel].pin : 0xFF;
+    }
+
+    uint32_t head(uint8_t pin) {
+        int c = channelIndex(pin);
+        if (c < 0) return 0;
+        return _channels[c].head.load(std::memory_order_acquire);
+    }
+
+    size_t read(uint8_t pin, uint32_t& cursor, uint16_t* out, size_t maxSamples) {
+        int c = channelIndex(pin);
+        if (c < 0) return 0;
+
+        Channel& ch = _channels[c];
+        // The next batch goes into the slots of the oldest ADC_SAMPLER_BATCH
+        // samples before the head moves, so those are never safe to read
+        const uint32_t safe = ADC_SAMPLER_RING_SIZE - ADC_SAMPLER_BATCH;
+        uint32_t head = ch.head.load(std::memory_order_acquire);
+        if (head - cursor > safe) {
+            cursor = head - safe; // Overrun: keep the newest samples
+        }
+
+        size_t count = min((size_t)(head - cursor), maxSamples);
+        for (size_t i = 0; i < count; i++) {
+            out[i] = ch.samples[(cursor + i) & (ADC_SAMPLER_RING_SIZE - 1)];
+        }
+
+        // The writer may have lapped the oldest copied samples meanwhile
+        uint32_t after = ch.head.load(std::memory_order_acquire);
+        if (after - cursor > safe) {
+            size_t lost = min((size_t)(after - cursor - safe), count);
+            memmove(out, out + lost, (count - lost) * sizeof(uint16_t));
+            count -= lost;
+            cursor += lost;
+        }
+        cursor += count;
+        return count;
+    }
+
+    size_t readBlocking(uint8_t pin, uint32_t& cursor, uint16_t* out, size_t count, uint32_t timeoutMs) {
+        size_t total = 0;
+        unsigned long start = millis();
+        while (total < count) {
+            total += read(pin, cursor, out + total, count - total);
+            if (total >= count || millis() - start > timeoutMs) break;
+#if defined(ESP32)
+            if (_task != NULL) { delay(1); continue; }
+#endif
+            if (poll() == 0) yield();
+        }
+        return total;
+    }
+
+    uint16_t readLatest(uint8_t pin) {
+        int c = channelIndex(pin);
+        if (c < 0) return 0;
+
+        // DMA delivers in bursts, so return the newest sample instead of waiting for the next one
+        uint32_t cursor = head(pin);
+        if (cursor == 0) {
+            uint16_t value = 0;
+            readBlocking(pin, cursor, &value, 1, 10);
+            return value;
+        }
+        return _channels[c].samples[(cursor - 1) & (ADC_SAMPLER_RING_SIZE - 1)];
+    }
+}
@@ -0,0 +1,51 @@
+// ADCSampler.h
+
+#ifndef ADC_SAMPLER_H
+#define ADC_SAMPLER_H
+
+#include <Arduino.h>
+
+#define ADC_SAMPLER_MAX_CHANNELS 8
+#define ADC_SAMPLER_RING_SIZE    2048 // Samples kept per channel (power of two), 204.8 ms at 10 kHz
+#define ADC_SAMPLER_BATCH        64   // Frames written per poll before the head moves
+
+namespace ADCSampler {
+    // Sample source: fills up to maxFrames interleaved frames (one sample per
+    // channel, in the pin order given to begin()) and returns the frame count.
+    // Works like ACS712::setADC - pass NULL to use the ESP32 DMA driver.
+    typedef size_t (*SampleSource)(uint16_t* frames, size_t maxFrames);
+
+    // Starts sampling the given ADC1 pins at sampleRateHz per channel
+    bool begin(const uint8_t* pins, uint8_t pinCount, uint32_t sampleRateHz);
+
+    // Replaces the sample source (synthetic or replay source in host builds)
+    void setSource(SampleSource source);
+
+    // Moves pending source data into the ring buffers. Called by the reader
+    // task on the device; host builds call it directly.
+    size_t poll();
+
+    bool isRunning();
+    uint32_t getSampleRate();
+
+    // Channels in frame order, as given to begin()
+    uint8_t getChannelCount();
+    uint8_t getPin(uint8_t channel);
+
+    // Total samples written so far for a pin; use it to start a read cursor
+    uint32_t head(uint8_t pin);
+
+    // Copies up to maxSamples new samples for a pin and advances the cursor.
+    // A cursor that fell behind skips to the oldest sample the writer cannot
+    // be overwriting (a batch less than a ring); samples the writer lapped
+    // during the copy are dropped the same way.
+    size_t read(uint8_t pin, uint32_t& cursor, uint16_t* out, size_t maxSamples);
+
+    // Like read(), but waits until count samples have arrived or timeoutMs passed
+    size_t readBlocking(uint8_t pin, uint32_t& cursor, uint16_t* out, size_t count, uint32_t timeoutMs = 100);
+
+    // Newest sample of a pin (waits only for the first one) - drop-in for ACS712::setADC
+    uint16_t readLatest(uint8_t pin);
+}
+
+#endif // ADC_SAMPLER_H
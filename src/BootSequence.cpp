@@ -0,0 +1,48 @@
+// BootSequence.cpp
+
+#include "BootSequence.h"
+
+namespace BootSequence {
+    static const char* const NAMES[BOOT_STAGE_COUNT] = {
+        "config", "pump", "sensors", "metering", "control", "wifi", "blynk", "mqtt", "time"
+    };
+
+    // Written once per stage by whichever task reaches it; 32-bit stores are atomic
+    static volatile uint32_t _readyMs[BOOT_STAGE_COUNT];
+
+    void mark(BootStage stage) {
+        if (stage >= BOOT_STAGE_COUNT || _readyMs[stage] != 0) return;
+        uint32_t now = millis();
+        _readyMs[stage] = now > 0 ? now : 1; // 0 means "not yet"
+        Serial.printf("🚀 Boot stage '%s' ready at %lu ms\n", NAMES[stage], (unsigned long)_readyMs[stage]);
+    }
+
+    bool isReady(BootStage stage) {
+        return stage < BOOT_STAGE_COUNT && _readyMs[stage] != 0;
+    }
+
+    uint32_t getReadyMs(BootStage stage) {
+        return stage < BOOT_STAGE_COUNT ? _readyMs[stage] : 0;
+    }
+
+    const char* getName(BootStage stage) {
+        return stage < BOOT_STAGE_COUNT ? NAMES[stage] : "?";
+    }
+
+    void print() {
+        Serial.println("🚀 Boot stages (ms since reset):");
+        for (uint8_t s = 0; s < BOOT_STAGE_COUNT; s++) {
+            if (_readyMs[s] != 0) {
+                Serial.printf("   %-10s %8lu\n", NAMES[s], (unsigned long)_readyMs[s]);
+            } else {
+                Serial.printf("   %-10s  pending\n", NAMES[s]);
+            }
+        }
+    }
+
+    bool handleCommand(const char* line) {
+        if (strcmp(line, "boot") != 0) return false;
+        print();
+        return true;
+    }
+}
@@ -0,0 +1,38 @@
+// BootSequence.h
+
+#ifndef BOOT_SEQUENCE_H
+#define BOOT_SEQUENCE_H
+
+#include <Arduino.h>
+
+// Boot stages in the order they normally complete. Local control comes up
+// from cached calibration first; the network stages finish in the background.
+enum BootStage {
+    BOOT_CONFIG,    // GPIO and calibration cache loaded
+    BOOT_PUMP,      // Relay pin driven to a known state
+    BOOT_SENSORS,   // Sonar, ADC sampler, ACS712 and CTs started
+    BOOT_METERING,  // Metering task and loop jobs running
+    BOOT_CONTROL,   // First pump decision made from a measured level
+    BOOT_WIFI,
+    BOOT_BLYNK,
+    BOOT_MQTT,
+    BOOT_TIME,      // NTP time set (buffered records get real timestamps)
+    BOOT_STAGE_COUNT
+};
+
+namespace BootSequence {
+    // Records when a stage became ready (ms since reset); later calls are ignored.
+    // Safe from any task.
+    void mark(BootStage stage);
+
+    bool isReady(BootStage stage);
+    uint32_t getReadyMs(BootStage stage); // 0 while not ready
+    const char* getName(BootStage stage);
+
+    void print();
+
+    // "boot" prints the stage table
+    bool handleCommand(const char* line);
+}
+
+#endif // BOOT_SEQUENCE_H
@@ -0,0 +1,103 @@
+// CTChannel.cpp
+#include "CTChannel.h"
+#include "ADCSampler.h"
+
+CTChannel::CTChannel()
+    : _ctPin(-1), _name("ct"), _calibration(185.0f), _rmsCurrent(0.0f),
+      _isConnected(false), _cursor(0), _zeroCycles(0) {
+}
+
+void CTChannel::begin(int ctPin, float calibration, const char* name) {
+    _ctPin = ctPin;
+    _calibration = calibration;
+    _name = name;
+    _rmsCurrent = 0.0f;
+
+    // No offset measurement: the RMS removes DC itself and the zero is learned online
+    _isConnected = (ADCSampler::readLatest(_ctPin) > 0);
+    if (_isConnected) {
+        _rms.begin(ADCSampler::getSampleRate(), (uint16_t)_zero.getMidpoint());
+        _zeroCycles = 0;
+        _cursor = ADCSampler::head(_ctPin);
+        Serial.printf("CT '%s' on GPIO %d started (midpoint %.1f, noise %.2f)\n",
+            _name, _ctPin, _zero.getMidpoint(), _zero.getNoise());
+    }
+}
+
+void CTChannel::restoreZero(float midpoint, float noise) {
+    _zero.restore(midpoint, noise);
+    if (_isConnected) _rms.begin(ADCSampler::getSampleRate(), (uint16_t)_zero.getMidpoint());
+    _zeroCycles = 0;
+}
+
+void CTChannel::push(const uint16_t* samples, size_t count) {
+    _rms.push(samples, count);
+}
+
+// Feeds every sample the background sampler collected since the last call
+void CTChannel::update() {
+    if (!_isConnected) return;
+
+    uint16_t samples[128];
+    size_t n;
+    while ((n = ADCSampler::read(_ctPin, _cursor, samples, 128)) > 0) {
+        _rms.push(samples, n);
+    }
+    compute();
+}
+
+void CTChannel::compute() {
+    if (!_isConnected) return;
+
+    // Cycles closed since the last call go to the auto-zero as one window
+    uint32_t total = _rms.getTotalCycles();
+    uint32_t fresh = min(total - _zeroCycles, (uint32_t)_rms.getCycleCount());
+    if (fresh > 0) _zero.addWindow(_rms.mean(fresh), _rms.rms(fresh), fresh);
+    _zeroCycles = total;
+
+    _rmsCurrent = _zero.correct(getRawRMS()) / _calibration;
+}
+
+// Covers the last CT_RMS_CYCLES whole mains cycles (~100 ms at 50 Hz)
+float CTChannel::getRawRMS() const {
+    return _rms.rms(CT_RMS_CYCLES);
+}
+
+float CTChannel::getCurrent(uint16_t cycles) const {
+    return _zero.correct(_rms.rms(cycles)) / _calibration;
+}
+
+float CTChannel::getCurrent() const {
+    return _rmsCurrent;
+}
+
+void CTChannel::setMainsFrequency(float hz) {
+    uint32_t rate = ADCSampler::getSampleRate();
+    _rms.setCycleLength(hz > 0 && rate > 0 ? rate / hz : 0);
+}
+
+// --- Dynamic Calibration Function ---
+void CTChannel::calibrate(float knownCurrent) {
+    // This function should be called with a known load connected.
+    if (!_isConnected || knownCurrent <= 0) return;
+
+    float rms_raw = 0.0f;
+    int measurementCount = 0;
+
+    // Average 10 readings to get a stable value
+    for (int i = 0; i < 10; i++) {
+        update();
+        rms_raw += getRawRMS();
+        measurementCount++;
+        delay(100); // Wait between readings
+    }
+
+    if (measurementCount > 0) {
+        rms_raw /= measurementCount;
+
+        // Calculate the new calibration factor: New Calibration = Raw RMS Value / Known Current
+        _calibration = rms_raw / knownCurrent;
+
+        Serial.printf("✅ New CT calibration factor for '%s': %.2f\n", _name, _calibration);
+    }
+}
@@ -0,0 +1,72 @@
+// CTChannel.h
+
+#ifndef CT_CHANNEL_H
+#define CT_CHANNEL_H
+
+#include <Arduino.h>
+#include "OffsetTracker.h"
+#include "RMSAccumulator.h"
+
+#define CT_RMS_CYCLES 5 // Whole mains cycles per reading
+
+// One current transformer on an ADCSampler pin, with its own calibration,
+// auto-zero and cycle-aligned RMS. CTManager runs several of them
+// from one interleaved scan; CTModule wraps the first one.
+class CTChannel {
+public:
+    CTChannel();
+
+    // Starts the channel on a sampler pin; the zero is learned while idle
+    void begin(int ctPin, float calibration, const char* name = "ct");
+
+    // Zero learned on a previous boot (midpoint and noise in ADC steps)
+    void restoreZero(float midpoint, float noise);
+
+    // Feeds samples the caller already read from the sampler
+    void push(const uint16_t* samples, size_t count);
+
+    // Reads everything new from the sampler, then updates the current
+    void update();
+
+    // Recomputes the current from the samples pushed so far
+    void compute();
+
+    // RMS current in A with the learned noise floor removed in quadrature
+    float getCurrent() const;
+
+    // RMS current over the last N closed mains cycles (noise removed)
+    float getCurrent(uint16_t cycles) const;
+
+    // Raw RMS in ADC steps over CT_RMS_CYCLES
+    float getRawRMS() const;
+
+    bool isConnected() const { return _isConnected; }
+    int getPin() const { return _ctPin; }
+    const char* getName() const { return _name; }
+    float getCalibration() const { return _calibration; }
+    const OffsetTracker& getZero() const { return _zero; }
+
+    // Calibrates the sensor with a known current (blocks ~1 s)
+    void calibrate(float knownCurrent);
+    void setCalibration(float calibration) { _calibration = calibration; }
+
+    // Locks the RMS windows to a measured mains frequency; 0 goes back to
+    // the CT's own zero crossings
+    void setMainsFrequency(float hz);
+
+    // Read position in the sampler ring, for callers that feed push()
+    uint32_t& cursor() { return _cursor; }
+
+private:
+    int _ctPin;
+    const char* _name;
+    float _calibration;
+    float _rmsCurrent;
+    bool _isConnected;
+    uint32_t _cursor;      // Read position in the sampler ring
+    uint32_t _zeroCycles;  // Closed cycles already given to _zero
+    RMSAccumulator _rms;   // Cycle-aligned running sums
+    OffsetTracker _zero;   // Midpoint and noise floor, learned while idle
+};
+
+#endif // CT_CHANNEL_H
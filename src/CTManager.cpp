@@ -0,0 +1,84 @@
+// CTManager.cpp
+
+#include "CTManager.h"
+#include "ADCSampler.h"
+
+#define CT_CHUNK_SAMPLES  128
+
+namespace CTManager {
+    struct Circuit {
+        int pin;
+        float calibration;
+        const char* name;
+    };
+
+    static CTChannel _channels[CT_MAX_CHANNELS];
+    static Circuit _circuits[CT_MAX_CHANNELS];
+    static uint8_t _channelCount = 0;
+
+    int8_t addChannel(int pin, float calibration, const char* name) {
+        int8_t existing = findChannel(pin);
+        if (existing >= 0) return existing;
+        if (_channelCount >= CT_MAX_CHANNELS) {
+            Serial.printf("⚠️ CT '%s' not added, %d channels max.\n", name, CT_MAX_CHANNELS);
+            return -1;
+        }
+        _circuits[_channelCount] = { pin, calibration, name };
+        return _channelCount++;
+    }
+
+    void begin() {
+        uint8_t connected = 0;
+        for (uint8_t c = 0; c < _channelCount; c++) {
+            _channels[c].begin(_circuits[c].pin, _circuits[c].calibration, _circuits[c].name);
+            if (_channels[c].isConnected()) connected++;
+        }
+        Serial.printf("🔌 CT manager: %d of %d circuit(s) connected.\n", connected, _channelCount);
+    }
+
+    // Drains the rings chunk by chunk across channels, so the samples of
+    // one scan are processed together while they are still in cache
+    void update() {
+        uint16_t samples[CT_CHUNK_SAMPLES];
+        bool more = true;
+        while (more) {
+            more = false;
+            for (uint8_t c = 0; c < _channelCount; c++) {
+                CTChannel& channel = _channels[c];
+                if (!channel.isConnected()) continue;
+                size_t n = ADCSampler::read(channel.getPin(), channel.cursor(), samples, CT_CHUNK_SAMPLES);
+                if (n == 0) continue;
+                channel.push(samples, n);
+                more = true;
+            }
+        }
+        for (uint8_t c = 0; c < _channelCount; c++) {
+            _channels[c].compute();
+        }
+    }
+
+    void setMainsFrequency(float hz) {
+        for (uint8_t c = 0; c < _channelCount; c++) {
+            _channels[c].setMainsFrequency(hz);
+        }
+    }
+
+    uint8_t getChannelCount() {
+        return _channelCount;
+    }
+
+    CTChannel* getChannel(uint8_t index) {
+        return index < _channelCount ? &_channels[index] : NULL;
+    }
+
+    int8_t findChannel(int pin) {
+        for (uint8_t c = 0; c < _channelCount; c++) {
+            if (_circuits[c].pin == pin) return c;
+        }
+        return -1;
+    }
+
+    float getCurrent(uint8_t index) {
+        return index < _channelCount ? _channels[index].getCurrent() : 0.0f;
+    }
+}
@@ -0,0 +1,37 @@
+// CTManager.h
+
+#ifndef CT_MANAGER_H
+#define CT_MANAGER_H
+
+#include <Arduino.h>
+#include "CTChannel.h"
+
+#define CT_MAX_CHANNELS 8 // ESP32 ADC1 has 8 inputs
+
+// Per-circuit metering: up to CT_MAX_CHANNELS current transformers on ADC1.
+// All pins must be in the ADCSampler scan, so one DMA pass converts every
+// circuit; update() drains every channel's ring in the same pass.
+namespace CTManager {
+    // Registers a circuit before begin(); returns its index or -1 when full
+    int8_t addChannel(int pin, float calibration, const char* name);
+
+    // Starts the channels; no offset measurement, each learns its zero while idle
+    void begin();
+
+    // Feeds the new samples of every channel, then recomputes every RMS
+    void update();
+
+    // Locks every channel's RMS windows to the mains frequency; 0 unlocks
+    void setMainsFrequency(float hz);
+
+    uint8_t getChannelCount();
+    CTChannel* getChannel(uint8_t index);
+
+    // Index of the channel on a pin, -1 when none
+    int8_t findChannel(int pin);
+
+    // RMS current of one channel in A with its noise floor removed, 0 when absent
+    float getCurrent(uint8_t index);
+}
+
+#endif // CT_MANAGER_H
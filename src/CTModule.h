@@ -1,36 +1,39 @@
-
 // CTModule.h
 
 #ifndef CT_MODULE_H
 #define CT_MODULE_H
 
 #include <Arduino.h>
+#include "CTChannel.h"
 
+// Single-circuit interface kept for the existing callers: the main CT is
+// the first channel of CTManager. Use CTManager for per-circuit metering.
 class CTModule {
 public:
     // Initializes the CT module on a specified pin with a calibration factor
     static void begin(int ctPin, float calibration);
 
-    // Updates sensor readings and performs calculations
+    // Updates sensor readings and performs calculations (all CT channels)
     static void update();
 
     // Returns the measured RMS current in Amperes
     static float getCurrent();
 
+    // Returns the RMS current over the last N closed mains cycles (no threshold)
+    static float getCurrent(uint16_t cycles);
+
     // Checks if the CT module is connected and working
     static bool isConnected();
 
     // Calibrates the sensor with a known current
     static void calibrate(float knownCurrent);
 
+    // Locks the RMS windows to a measured mains frequency; 0 goes back to
+    // the CT's own zero crossings
+    static void setMainsFrequency(float hz);
+
 private:
-    static float getRawRMS();
-    static int setupNoLoadOffset();
-    static int _ctPin;
-    static float _calibration;
-    static float _rmsCurrent;
-    static bool _isConnected;
-    static int _noLoadOffset;
+    static CTChannel* channel();
 };
 
-#endif // CT_MODULE_H
\ No newline at end of file
+#endif // CT_MODULE_H
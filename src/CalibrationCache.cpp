@@ -0,0 +1,99 @@
+// CalibrationCache.cpp
+
+#include "CalibrationCache.h"
+#include <Preferences.h>
+
+#define CALIBRATION_NAMESPACE "calib"
+#define ZERO_MIDPOINT_DELTA   0.5f  // ADC steps a saved midpoint may drift unsaved
+#define ZERO_NOISE_DELTA      0.25f
+
+namespace CalibrationCache {
+    static Preferences _prefs;
+    static bool _open = false;
+
+    // A zero is two keys, "<sensor>m" (midpoint) and "<sensor>n" (noise)
+    static bool getZero(const char* sensor, float& midpoint, float& noise) {
+        char key[12];
+        snprintf(key, sizeof(key), "%sm", sensor);
+        if (!_open || !_prefs.isKey(key)) return false;
+        midpoint = _prefs.getFloat(key, 0.0f);
+        snprintf(key, sizeof(key), "%sn", sensor);
+        noise = _prefs.getFloat(key, 0.0f);
+        return true;
+    }
+
+    static void setZero(const char* sensor, float midpoint, float noise) {
+        float cachedMidpoint, cachedNoise;
+        if (getZero(sensor, cachedMidpoint, cachedNoise)
+            && fabsf(cachedMidpoint - midpoint) < ZERO_MIDPOINT_DELTA
+            && fabsf(cachedNoise - noise) < ZERO_NOISE_DELTA) return; // Spare the flash
+        if (!_open) return;
+
+        char key[12];
+        snprintf(key, sizeof(key), "%sm", sensor);
+        _prefs.putFloat(key, midpoint);
+        snprintf(key, sizeof(key), "%sn", sensor);
+        _prefs.putFloat(key, noise);
+    }
+
+    bool begin() {
+        if (!_open) _open = _prefs.begin(CALIBRATION_NAMESPACE, false);
+        if (!_open) Serial.println("⚠️ Calibration cache (NVS) unavailable, learning zeros from scratch.");
+        return _open;
+    }
+
+    bool getACSZero(float& midpoint, float& noise) {
+        return getZero("acs", midpoint, noise);
+    }
+
+    void setACSZero(float midpoint, float noise) {
+        setZero("acs", midpoint, noise);
+    }
+
+    bool getCTZero(int pin, float& midpoint, float& noise) {
+        char sensor[8];
+        snprintf(sensor, sizeof(sensor), "ct%d", pin);
+        return getZero(sensor, midpoint, noise);
+    }
+
+    void setCTZero(int pin, float midpoint, float noise) {
+        char sensor[8];
+        snprintf(sensor, sizeof(sensor), "ct%d", pin);
+        setZero(sensor, midpoint, noise);
+    }
+
+    bool getSonarPresent(bool& present) {
+        if (!_open || !_prefs.isKey("sonar")) return false;
+        present = _prefs.getBool("sonar", false);
+        return true;
+    }
+
+    void setSonarPresent(bool present) {
+        bool cached;
+        if (getSonarPresent(cached) && cached == present) return; // Spare the flash
+        if (_open) _prefs.putBool("sonar", present);
+    }
+
+    void clear() {
+        if (_open) _prefs.clear();
+        Serial.println("🧹 Calibration cache cleared, the next boot learns again.");
+    }
+
+    bool handleCommand(const char* line) {
+        if (strcmp(line, "calib clear") == 0) {
+            clear();
+            return true;
+        }
+        if (strcmp(line, "calib") != 0) return false;
+
+        float midpoint, noise;
+        bool sonar;
+        Serial.println("📏 Calibration cache:");
+        if (getACSZero(midpoint, noise)) Serial.printf("   ACS712 zero: %.1f, noise %.2f steps\n", midpoint, noise);
+        if (getSonarPresent(sonar)) Serial.printf("   Sonar: %s\n", sonar ? "present" : "absent");
+        for (int pin = 32; pin <= 39; pin++) {
+            if (getCTZero(pin, midpoint, noise)) Serial.printf("   CT GPIO %d zero: %.1f, noise %.2f steps\n", pin, midpoint, noise);
+        }
+        return true;
+    }
+}
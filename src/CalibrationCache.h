@@ -0,0 +1,35 @@
+// CalibrationCache.h
+
+#ifndef CALIBRATION_CACHE_H
+#define CALIBRATION_CACHE_H
+
+#include <Arduino.h>
+
+// Sensor calibration kept in NVS ("calib" preferences) so a reboot can start
+// measuring at once instead of re-measuring with whatever load is running.
+// Current sensor zeros are learned online (OffsetTracker) and saved here
+// now and then; setters skip the write unless the value really moved.
+namespace CalibrationCache {
+    // Loads the cached values; false when the namespace cannot be opened
+    bool begin();
+
+    // ACS712 zero: midpoint and idle noise, in ADC steps
+    bool getACSZero(float& midpoint, float& noise);
+    void setACSZero(float midpoint, float noise);
+
+    // CT zero per pin, in ADC steps
+    bool getCTZero(int pin, float& midpoint, float& noise);
+    void setCTZero(int pin, float midpoint, float noise);
+
+    // Whether the sonar answered on the last probe; skips the blocking probe
+    bool getSonarPresent(bool& present);
+    void setSonarPresent(bool present);
+
+    // Forgets everything; the next boot learns again
+    void clear();
+
+    // "calib" prints the cache, "calib clear" clears it
+    bool handleCommand(const char* line);
+}
+
+#endif // CALIBRATION_CACHE_H
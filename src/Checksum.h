@@ -0,0 +1,14 @@
+// Checksum.h
+
+#ifndef CHECKSUM_H
+#define CHECKSUM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace Checksum {
+    // CRC-32 (IEEE 802.3); pass the previous result as seed to chain blocks
+    uint32_t crc32(const void* data, size_t length, uint32_t seed = 0);
+}
+
+#endif // CHECKSUM_H
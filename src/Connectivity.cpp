@@ -0,0 +1,69 @@
+// Connectivity.cpp
+
+#include "Connectivity.h"
+#include "WiFiModule.h"
+#include <time.h>
+
+#define CONNECTIVITY_POLL_MS 50
+
+namespace Connectivity {
+    struct Link {
+        const char* name;
+        LinkFunction connect;
+        LinkFunction online;
+        BootStage stage;
+        uint32_t retryMs;
+        unsigned long lastAttemptMs;
+        bool attempted;
+    };
+
+    static Link _links[CONNECTIVITY_MAX_LINKS];
+    static uint8_t _linkCount = 0;
+    static void (*_onWiFiUp)() = NULL;
+
+    void addLink(const char* name, LinkFunction connect, LinkFunction online, BootStage stage, uint32_t retryMs) {
+        if (_linkCount >= CONNECTIVITY_MAX_LINKS || connect == NULL || online == NULL) return;
+        _links[_linkCount++] = { name, connect, online, stage, retryMs, 0, false };
+    }
+
+    void onWiFiUp(void (*callback)()) {
+        _onWiFiUp = callback;
+    }
+
+    static void serviceLinks() {
+        for (uint8_t i = 0; i < _linkCount; i++) {
+            Link& link = _links[i];
+            if (link.online()) continue;
+            if (link.attempted && millis() - link.lastAttemptMs < link.retryMs) continue;
+            link.attempted = true;
+            link.lastAttemptMs = millis();
+            if (link.connect()) BootSequence::mark(link.stage);
+        }
+    }
+
+    static void connectivityTask(void*) {
+        bool wifiSeen = false;
+        for (;;) {
+            WiFiModule::loop();
+            if (WiFiModule::isConnected()) {
+                if (!wifiSeen) {
+                    wifiSeen = true;
+                    BootSequence::mark(BOOT_WIFI);
+                    if (_onWiFiUp) _onWiFiUp();
+                }
+                serviceLinks();
+                if (!BootSequence::isReady(BOOT_TIME) && time(NULL) > 1600000000) {
+                    BootSequence::mark(BOOT_TIME);
+                }
+            }
+            vTaskDelay(pdMS_TO_TICKS(CONNECTIVITY_POLL_MS));
+        }
+    }
+
+    void begin() {
+        // Same core and priority as loop(): while a connect blocks on the
+        // network the scheduler keeps running loop() in between
+        xTaskCreatePinnedToCore(connectivityTask, "connectivity", 10240, NULL, 1, NULL, 1);
+        Serial.println("📡 Connecting WiFi, Blynk and MQTT in the background.");
+    }
+}
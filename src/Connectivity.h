@@ -0,0 +1,29 @@
+// Connectivity.h
+
+#ifndef CONNECTIVITY_H
+#define CONNECTIVITY_H
+
+#include <Arduino.h>
+#include "BootSequence.h"
+
+#define CONNECTIVITY_MAX_LINKS 4
+
+// Brings WiFi and the cloud links up from a background task, so setup()
+// and the pump never wait for a login. A link's connect function may block
+// (DNS, TLS); it only runs while the link reports offline, and loop() only
+// touches a client once it reports online, so the two never share it.
+namespace Connectivity {
+    typedef bool (*LinkFunction)();
+
+    // connect: one blocking attempt, true when up; online: cheap flag check.
+    // The stage is marked on the first success. Call before begin().
+    void addLink(const char* name, LinkFunction connect, LinkFunction online, BootStage stage, uint32_t retryMs);
+
+    // Called once when WiFi first connects (e.g. to start the web server)
+    void onWiFiUp(void (*callback)());
+
+    // Starts the task; WiFiModule::begin() must have run
+    void begin();
+}
+
+#endif // CONNECTIVITY_H
@@ -0,0 +1,141 @@
+// Diagnostics.cpp
+
+#include "Diagnostics.h"
+#include "MQTTModule.h"
+#include "MeteringTask.h"
+#include "BootSequence.h"
+#include "TelemetryPipeline.h"
+#include "StoreForward.h"
+#include <stdarg.h>
+
+namespace Diagnostics {
+    static const Scheduler* _schedulers[DIAGNOSTICS_MAX_SCHEDULERS];
+    static uint8_t _schedulerCount = 0;
+    static char _topic[64];
+    static char _payload[DIAGNOSTICS_PAYLOAD_SIZE];
+    static CommandHandler _handlers[DIAGNOSTICS_MAX_COMMANDS];
+    static uint8_t _handlerCount = 0;
+    static char _command[32];
+    static uint8_t _commandLength = 0;
+
+    void begin(const char* deviceId) {
+        snprintf(_topic, sizeof(_topic), "home_iot/%s/diag", deviceId);
+    }
+
+    void addScheduler(const Scheduler* scheduler) {
+        if (scheduler != NULL && _schedulerCount < DIAGNOSTICS_MAX_SCHEDULERS) {
+            _schedulers[_schedulerCount++] = scheduler;
+        }
+    }
+
+    void addCommandHandler(CommandHandler handler) {
+        if (handler != NULL && _handlerCount < DIAGNOSTICS_MAX_COMMANDS) {
+            _handlers[_handlerCount++] = handler;
+        }
+    }
+
+    void printStats() {
+        for (uint8_t i = 0; i < _schedulerCount; i++) {
+            _schedulers[i]->printStats();
+        }
+        Serial.printf("   Dropped frames: %lu\n", (unsigned long)MeteringTask::getDroppedFrames());
+
+        const TelemetryPipeline::Stats& tel = TelemetryPipeline::getStats();
+        Serial.printf("📤 Telemetry: %lu batches, %lu samples, %lu bytes sent, %lu publish failures%s\n",
+            (unsigned long)tel.batchesSent, (unsigned long)tel.samplesSent, (unsigned long)tel.bytesSent,
+            (unsigned long)tel.publishFailures, tel.inFlight ? ", batch in flight" : "");
+        Serial.printf("   Samples dropped: %lu, stored: %lu, backfilled: %lu, pending: %lu\n",
+            (unsigned long)tel.samplesDropped, (unsigned long)tel.samplesStored,
+            (unsigned long)tel.backfillSent, (unsigned long)StoreForward::pending());
+    }
+
+    void resetStats() {
+        // The metering task may be recording meanwhile; a count or two can be lost
+        for (uint8_t i = 0; i < _schedulerCount; i++) {
+            const_cast<Scheduler*>(_schedulers[i])->resetStats();
+        }
+        Serial.println("🧹 Latency stats cleared.");
+    }
+
+    static void runCommand() {
+        if (strcmp(_command, "stats") == 0) {
+            printStats();
+        } else if (strcmp(_command, "stats reset") == 0) {
+            resetStats();
+        } else if (_commandLength > 0) {
+            for (uint8_t i = 0; i < _handlerCount; i++) {
+                if (_handlers[i](_command)) return;
+            }
+            Serial.printf("❓ Unknown command '%s' (try: stats, stats reset)\n", _command);
+        }
+    }
+
+    void handleSerial() {
+        while (Serial.available() > 0) {
+            char c = Serial.read();
+            if (c == '\r' || c == '\n') {
+                _command[_commandLength] = '\0';
+                runCommand();
+                _commandLength = 0;
+            } else if (_commandLength < sizeof(_command) - 1) {
+                _command[_commandLength++] = c;
+            }
+        }
+    }
+
+    // Appends with snprintf; returns false once the buffer is full
+    static bool append(size_t& length, const char* format, ...) {
+        va_list args;
+        va_start(args, format);
+        int written = vsnprintf(_payload + length, sizeof(_payload) - length, format, args);
+        va_end(args);
+        if (written < 0 || length + written >= sizeof(_payload)) return false;
+        length += written;
+        return true;
+    }
+
+    // {"up":s,"drop":n,"boot":[ms per BootStage, 0 = pending],
+    //  "sched":[{"n":"loop","pass":[p50,p99,max],
+    //   "jobs":[["pump",runs,p50,p99,max,overruns,misses],...]},...],
+    //  "tel":[batches,samples,bytes,failures,dropped,stored,backfilled,pending]}
+    bool publish() {
+        if (!MQTTModule::isConnected()) return false;
+
+        size_t length = 0;
+        bool ok = append(length, "{\"up\":%lu,\"drop\":%lu,\"boot\":[",
+            (unsigned long)(millis() / 1000), (unsigned long)MeteringTask::getDroppedFrames());
+        for (uint8_t s = 0; ok && s < BOOT_STAGE_COUNT; s++) {
+            ok = append(length, "%s%lu", s ? "," : "", (unsigned long)BootSequence::getReadyMs((BootStage)s));
+        }
+        if (ok) ok = append(length, "],\"sched\":[");
+        for (uint8_t s = 0; ok && s < _schedulerCount; s++) {
+            const Scheduler& scheduler = *_schedulers[s];
+            const LatencyHistogram& pass = scheduler.getPassTime();
+            ok = append(length, "%s{\"n\":\"%s\",\"pass\":[%lu,%lu,%lu],\"jobs\":[", s ? "," : "",
+                scheduler.getName(),
+                (unsigned long)pass.percentile(50), (unsigned long)pass.percentile(99), (unsigned long)pass.getMax());
+            for (uint8_t j = 0; ok && j < scheduler.getJobCount(); j++) {
+                const Scheduler::Job& job = scheduler.getJob(j);
+                ok = append(length, "%s[\"%s\",%lu,%lu,%lu,%lu,%lu,%lu]", j ? "," : "",
+                    job.name,
+                    (unsigned long)job.runs,
+                    (unsigned long)job.runTime.percentile(50),
+                    (unsigned long)job.runTime.percentile(99),
+                    (unsigned long)job.runTime.getMax(),
+                    (unsigned long)job.overruns,
+                    (unsigned long)job.misses);
+            }
+            if (ok) ok = append(length, "]}");
+        }
+        const TelemetryPipeline::Stats& tel = TelemetryPipeline::getStats();
+        if (ok) ok = append(length, "],\"tel\":[%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu]}",
+            (unsigned long)tel.batchesSent, (unsigned long)tel.samplesSent, (unsigned long)tel.bytesSent,
+            (unsigned long)tel.publishFailures, (unsigned long)tel.samplesDropped, (unsigned long)tel.samplesStored,
+            (unsigned long)tel.backfillSent, (unsigned long)StoreForward::pending());
+        if (!ok) {
+            Serial.println("⚠️ Diagnostics payload too large, not sent.");
+            return false;
+        }
+        return MQTTModule::publish(_topic, (const uint8_t*)_payload, length);
+    }
+}
@@ -0,0 +1,37 @@
+// Diagnostics.h
+
+#ifndef DIAGNOSTICS_H
+#define DIAGNOSTICS_H
+
+#include <Arduino.h>
+#include "Scheduler.h"
+
+#define DIAGNOSTICS_MAX_SCHEDULERS 2
+#define DIAGNOSTICS_MAX_COMMANDS   4
+#define DIAGNOSTICS_PAYLOAD_SIZE   1536
+
+namespace Diagnostics {
+    // Diagnostic payloads go to home_iot/<deviceId>/diag
+    void begin(const char* deviceId);
+
+    // Job tables to report (loop() and the metering task)
+    void addScheduler(const Scheduler* scheduler);
+
+    // Serial command handler; returns false when the line is not its command
+    typedef bool (*CommandHandler)(const char* line);
+    void addCommandHandler(CommandHandler handler);
+
+    // Reads serial commands: "stats" prints the job tables and telemetry
+    // counters, "stats reset" clears the latency stats; other lines go to the
+    // registered handlers (boot, calib, capture)
+    void handleSerial();
+
+    void printStats();
+    void resetStats();
+
+    // Publishes boot stage times, p50/p99/max per job and per pass and the
+    // telemetry counters as compact JSON; false when offline
+    bool publish();
+}
+
+#endif // DIAGNOSTICS_H
@@ -0,0 +1,111 @@
+// EnergyJournal.cpp
+
+#include "EnergyJournal.h"
+#include "Checksum.h"
+#include <string.h>
+
+#define ENERGY_RECORD_MAGIC 0x454E5247UL // "ENRG"
+
+EnergyJournal::EnergyJournal(FlashStorage& storage)
+    : _storage(storage), _ready(false), _sequence(0), _nextOffset(0),
+      _lastCommitMs(0), _energy_mWs(0), _peakPower_mW(0) {}
+
+uint32_t EnergyJournal::recordsPerSector() const {
+    return _storage.sectorSize() / sizeof(Record);
+}
+
+bool EnergyJournal::isBlank(uint32_t offset) {
+    uint32_t words[sizeof(Record) / 4];
+    if (!_storage.read(offset, words, sizeof(words))) return false;
+    for (size_t i = 0; i < sizeof(words) / 4; i++) {
+        if (words[i] != 0xFFFFFFFFUL) return false;
+    }
+    return true;
+}
+
+bool EnergyJournal::readRecord(uint32_t offset, Record& record) {
+    if (!_storage.read(offset, &record, sizeof(record))) return false;
+    if (record.magic != ENERGY_RECORD_MAGIC) return false;
+    return record.crc == Checksum::crc32(&record, offsetof(Record, crc));
+}
+
+bool EnergyJournal::begin() {
+    if (!_storage.begin() || _storage.sectorCount() < 2) return false;
+
+    uint32_t perSector = recordsPerSector();
+    uint32_t newestOffset = 0;
+    bool found = false;
+
+    // Records are appended in order, so each sector ends at its first blank slot
+    for (uint32_t sector = 0; sector < _storage.sectorCount(); sector++) {
+        for (uint32_t slot = 0; slot < perSector; slot++) {
+            uint32_t offset = sector * _storage.sectorSize() + slot * sizeof(Record);
+            Record record;
+            if (readRecord(offset, record)) {
+                if (!found || (int32_t)(record.sequence - _sequence) > 0) {
+                    found = true;
+                    _sequence = record.sequence;
+                    _energy_mWs = record.energy_mWs;
+                    _peakPower_mW = record.peakPower_mW;
+                    newestOffset = offset;
+                }
+            } else if (isBlank(offset)) {
+                break;
+            }
+        }
+    }
+
+    // Continue after the newest record; a torn write just costs its slot
+    _nextOffset = found ? newestOffset + sizeof(Record) : _storage.size();
+    _ready = true;
+    return found;
+}
+
+bool EnergyJournal::update(int64_t energy_mWs, uint32_t peakPower_mW, uint32_t nowMs) {
+    uint32_t sinceCommit = nowMs - _lastCommitMs;
+    int64_t delta = energy_mWs - _energy_mWs;
+
+    bool heartbeat = sinceCommit >= ENERGY_JOURNAL_COMMIT_INTERVAL_MS && (delta != 0 || peakPower_mW != _peakPower_mW);
+    bool bigChange = sinceCommit >= ENERGY_JOURNAL_MIN_INTERVAL_MS && delta >= ENERGY_JOURNAL_DELTA_MWS;
+    if (!heartbeat && !bigChange) return false;
+
+    return commit(energy_mWs, peakPower_mW, nowMs);
+}
+
+bool EnergyJournal::commit(int64_t energy_mWs, uint32_t peakPower_mW, uint32_t nowMs) {
+    if (!_ready) return false;
+
+    Record record;
+    memset(&record, 0, sizeof(record));
+    record.magic = ENERGY_RECORD_MAGIC;
+    record.sequence = _sequence + 1;
+    record.energy_mWs = energy_mWs;
+    record.peakPower_mW = peakPower_mW;
+    record.crc = Checksum::crc32(&record, offsetof(Record, crc));
+
+    uint32_t sectorSize = _storage.sectorSize();
+    uint32_t perSector = recordsPerSector();
+    for (uint32_t attempts = 0; attempts <= perSector; attempts++) {
+        // Wrap inside the storage and skip the unused tail of a sector
+        if (_nextOffset % sectorSize >= perSector * sizeof(Record)) {
+            _nextOffset += sectorSize - (_nextOffset % sectorSize);
+        }
+        if (_nextOffset >= _storage.size()) _nextOffset = 0;
+
+        // Entering a sector: erase it, the newest record lives in the previous one
+        if (_nextOffset % sectorSize == 0 && !_storage.eraseSector(_nextOffset / sectorSize)) return false;
+
+        uint32_t offset = _nextOffset;
+        _nextOffset += sizeof(Record);
+        if (!isBlank(offset)) continue; // Torn write from an earlier power loss
+
+        if (!_storage.write(offset, &record, sizeof(record))) return false;
+
+        _sequence = record.sequence;
+        _energy_mWs = energy_mWs;
+        _peakPower_mW = peakPower_mW;
+        _lastCommitMs = nowMs;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,58 @@
+// EnergyJournal.h
+
+#ifndef ENERGY_JOURNAL_H
+#define ENERGY_JOURNAL_H
+
+#include "FlashStorage.h"
+
+#define ENERGY_JOURNAL_COMMIT_INTERVAL_MS (15UL * 60UL * 1000UL) // Heartbeat commit
+#define ENERGY_JOURNAL_MIN_INTERVAL_MS    (5UL * 60UL * 1000UL)  // Fastest commit rate
+#define ENERGY_JOURNAL_DELTA_MWS          (10LL * 3600LL * 1000LL) // 10 Wh forces a commit
+
+// Append-only, CRC-checked counter journal. Records are written round-robin
+// through all sectors of the storage, so a sector is only erased when the
+// journal wraps onto it. At one record per 5 minutes a 4 KB sector lasts
+// over 10 hours.
+class EnergyJournal {
+public:
+    explicit EnergyJournal(FlashStorage& storage);
+
+    // Scans the storage and restores the newest valid record
+    bool begin();
+
+    // Batched write: commits when the heartbeat interval passed or the
+    // energy moved by ENERGY_JOURNAL_DELTA_MWS (rate limited)
+    bool update(int64_t energy_mWs, uint32_t peakPower_mW, uint32_t nowMs);
+
+    // Writes a record now (e.g. before an OTA reboot)
+    bool commit(int64_t energy_mWs, uint32_t peakPower_mW, uint32_t nowMs);
+
+    int64_t getEnergy() const { return _energy_mWs; }
+    uint32_t getPeakPower() const { return _peakPower_mW; }
+    uint32_t getSequence() const { return _sequence; }
+    bool hasRecord() const { return _sequence > 0; }
+
+private:
+    struct Record {
+        uint32_t magic;
+        uint32_t sequence;
+        int64_t energy_mWs;
+        uint32_t peakPower_mW;
+        uint32_t reserved[2];
+        uint32_t crc;
+    };
+
+    bool isBlank(uint32_t offset);
+    bool readRecord(uint32_t offset, Record& record);
+    uint32_t recordsPerSector() const;
+
+    FlashStorage& _storage;
+    bool _ready;
+    uint32_t _sequence;
+    uint32_t _nextOffset;
+    uint32_t _lastCommitMs;
+    int64_t _energy_mWs;
+    uint32_t _peakPower_mW;
+};
+
+#endif // ENERGY_JOURNAL_H
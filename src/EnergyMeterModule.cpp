@@ -4,20 +4,152 @@
 #include "EnergyMeterModule.h"
 #include <Arduino.h>
 #include "ACS712.h"
+#include "ADCSampler.h"
+#include "EnergyJournal.h"
+#include "FrequencyTracker.h"
+#include "HarmonicAnalyzer.h"
+#include "OffsetTracker.h"
+#include "PartitionFlashStorage.h"
+
+#define MAINS_FREQUENCY 50 // Nominal; the windows follow the tracked frequency
+#define PHASE_HISTORY   4  // Samples kept before a window for phase alignment
+#define MAX_WINDOWS     32 // Cycles integrated per update (the ring holds fewer)
+#define READABLE_SAMPLES (ADC_SAMPLER_RING_SIZE - ADC_SAMPLER_BATCH - PHASE_HISTORY) // Safe behind the head
 
 namespace EnergyMeterModule {
     // ACS712 object
     static ACS712 acs(0, 0, 0, 0); // Placeholder, will be configured in begin()
     
     // Data storage for calculations
-    static float _totalEnergykWh = 0.0;
+    static int64_t _energy_mWs = 0;          // Cumulative energy in milliwatt-seconds
+    static uint64_t _energyRemainder = 0;    // Sub-mWs carry in milliwatt-microseconds
     static float _peakPower = 0.0;
     static float _lastSampledPower = 0.0;
-    static unsigned long _lastUpdateTime = 0;
+    static float _lastWindowPower = 0.0;     // Left edge of the next trapezoid
+    static unsigned long _lastUpdateMicros = 0;
+    static uint32_t _cursor = 0;             // Read position in the sampler ring
     static int _acs712Pin;
     static bool _sensorConnected = false;
     static float _voltageCalibration = 220.0;
-    static float _noLoadOffset = 0.0; // New variable to store the zero-offset
+    static OffsetTracker _zero;              // ACS712 midpoint and noise floor, learned while idle
+    static HarmonicAnalyzer _harmonics;      // A few cycles per second of the current
+    static FrequencyTracker _frequency;      // Mains period, from voltage or current
+    static float _windowPhase = 0.0f;        // Fraction of a sample carried between windows
+    static uint32_t _droppedSamples = 0;     // Overwritten before update() got to them
+
+    // Voltage channel (ZMPT101B); without it power is I x _voltageCalibration
+    static int _voltagePin = -1;
+    static bool _hasVoltage = false;
+    static float _voltsPerStep = 1.0f;
+    static float _phaseDegrees = 0.0f;        // Sensor lag, from setVoltageSensor()
+    static float _voltageDelay = 0.0f;        // Samples to delay voltage (< 0: delay current)
+
+    // Results of the last update, averaged over its cycles
+    static float _lastVrms = 0.0f;
+    static float _lastIrms = 0.0f;
+    static float _lastApparentPower = 0.0f;
+    static float _lastReactivePower = 0.0f;
+
+    static uint16_t _currentWindow[ADC_SAMPLER_RING_SIZE + PHASE_HISTORY];
+    static uint16_t _voltageWindow[ADC_SAMPLER_RING_SIZE + PHASE_HISTORY];
+
+    // Persistent counters ("energy" partition in partitions.csv)
+#if defined(ESP32)
+    static PartitionFlashStorage _partitionStorage("energy");
+    static FlashStorage* _storage = &_partitionStorage;
+#else
+    static FlashStorage* _storage = NULL;
+#endif
+    static EnergyJournal* _journal = NULL;
+
+    float readRMSCurrent();
+
+    void setStorage(FlashStorage* storage) {
+        _storage = storage;
+    }
+
+    void restoreZero(float midpoint, float noise) {
+        _zero.restore(midpoint, noise);
+    }
+
+    const OffsetTracker& getZero() {
+        return _zero;
+    }
+
+    // Noise floor in mA, removed in quadrature from the RMS current
+    static float noiseFloor_mA() {
+        return _zero.getNoise() * acs.getmAPerStep();
+    }
+
+    static float removeNoise(float current_mA) {
+        float noise_mA = noiseFloor_mA();
+        float squared = current_mA * current_mA - noise_mA * noise_mA;
+        return squared > 0 ? sqrtf(squared) : 0.0f;
+    }
+
+    void setVoltageSensor(int voltagePin, float voltsPerStep, float phaseDegrees) {
+        _voltagePin = voltagePin;
+        _voltsPerStep = voltsPerStep;
+        _phaseDegrees = phaseDegrees;
+    }
+
+    static int channelIndex(int pin) {
+        for (uint8_t c = 0; c < ADCSampler::getChannelCount(); c++) {
+            if (ADCSampler::getPin(c) == pin) return c;
+        }
+        return -1;
+    }
+
+    // The sensor counts as present when one cycle shows a real AC swing
+    static bool detectVoltage() {
+        if (_voltagePin < 0 || channelIndex(_voltagePin) < 0) return false;
+
+        uint32_t n = (uint32_t)(_frequency.getPeriodSamples() + 0.5f);
+        if (n > ADC_SAMPLER_RING_SIZE) n = ADC_SAMPLER_RING_SIZE;
+        uint32_t head = ADCSampler::head(_voltagePin);
+        uint32_t cursor = (head > n) ? head - n : 0;
+        size_t count = ADCSampler::readBlocking(_voltagePin, cursor, _voltageWindow, n);
+        if (count < n / 2) return false;
+
+        uint16_t minimum = 4095, maximum = 0;
+        for (size_t i = 0; i < count; i++) {
+            if (_voltageWindow[i] < minimum) minimum = _voltageWindow[i];
+            if (_voltageWindow[i] > maximum) maximum = _voltageWindow[i];
+        }
+        return maximum - minimum > 100 && minimum > 0 && maximum < 4095;
+    }
+
+    // Channels are converted one after the other, so the voltage sample of a
+    // frame is taken later than the current sample; the sensor lags on top
+    static void computePhaseDelay() {
+        int currentIndex = channelIndex(_acs712Pin);
+        int voltageIndex = channelIndex(_voltagePin);
+        float skew = (float)(voltageIndex - currentIndex) / ADCSampler::getChannelCount();
+        float lag = _phaseDegrees / 360.0f * _frequency.getPeriodSamples();
+        _voltageDelay = constrain(skew - lag, -(PHASE_HISTORY - 1.0f), PHASE_HISTORY - 1.0f);
+    }
+
+    // Restores the totals from the journal so reboots don't reset the meter
+    static void restoreState() {
+        if (_storage == NULL) return;
+        static EnergyJournal journal(*_storage);
+        _journal = &journal;
+
+        unsigned long start = micros();
+        if (_journal->begin()) {
+            _energy_mWs = _journal->getEnergy();
+            _peakPower = _journal->getPeakPower() / 1000.0;
+            Serial.printf("💾 Energy restored: %.4f kWh (record %lu, %lu us)\n",
+                _energy_mWs / 3.6e9, (unsigned long)_journal->getSequence(), micros() - start);
+        } else {
+            Serial.println("💾 No energy journal found, starting from zero.");
+        }
+    }
+
+    void saveState() {
+        if (_journal == NULL) return;
+        _journal->commit(_energy_mWs, (uint32_t)(_peakPower * 1000.0), millis());
+    }
 
     bool isConnected() {
         if (_acs712Pin <= 0) {
@@ -25,7 +157,7 @@ namespace EnergyMeterModule {
         }
         
         // Take a stable reading to determine if the sensor is present.
-        int sensorReading = analogRead(_acs712Pin);
+        int sensorReading = ADCSampler::readLatest(_acs712Pin);
         
         // Check if the reading is not at the ADC's max or min
         if (sensorReading < 100 || sensorReading > 4000) {
@@ -44,10 +176,28 @@ namespace EnergyMeterModule {
 
             // Initialize the ACS712 object with ESP32-specific values
             acs = ACS712(acs712Pin, 3.3, 4095, sensitivity);
+            // Legacy blocking calls read from the sampler instead of analogRead
+            acs.setADC(ADCSampler::readLatest, 3.3, 4095);
             
-            // Perform manual offset calibration with no load
-            _noLoadOffset = acs.mA_AC();
-            Serial.printf("Sensor calibrated with no-load offset: %.2f mA\n", _noLoadOffset);
+            // No calibration pass: the zero is learned whenever the load is off
+            _frequency.begin(ADCSampler::getSampleRate(), MAINS_FREQUENCY);
+            acs.setMidPoint((uint16_t)lroundf(_zero.getMidpoint()));
+            Serial.printf("Sensor zero %s: midpoint %.1f, noise %.2f mA\n",
+                _zero.isLearned() ? "cached" : "not learned yet", _zero.getMidpoint(), noiseFloor_mA());
+
+            _hasVoltage = detectVoltage();
+            if (_hasVoltage) {
+                computePhaseDelay();
+                Serial.printf("🔌 Voltage sensor on GPIO %d (phase delay %.2f samples), real power metering.\n",
+                    _voltagePin, _voltageDelay);
+            } else {
+                Serial.printf("⚠️ No voltage sensor, power = current x %.0f V.\n", _voltageCalibration);
+            }
+
+            restoreState();
+            _harmonics.begin();
+            _cursor = max(ADCSampler::head(_acs712Pin), (uint32_t)PHASE_HISTORY);
+            _lastUpdateMicros = micros();
 
             Serial.println("⚡ Energy Meter detected.");
         } else {
@@ -57,93 +207,267 @@ namespace EnergyMeterModule {
     }
 
     
-    // Measure RMS current over N samples
-    float readRMSCurrent(int numSamples = 2000) {
+    // Measure RMS current over the newest mains cycle in the sampler ring
+    float readRMSCurrent() {
         if (!_sensorConnected) return 0.0;
 
-        double sumSquares = 0.0;
-        for (int i = 0; i < numSamples; i++) {
-            int sample = analogRead(_acs712Pin);
-            float current_mA = acs.mA_AC(sample) - _noLoadOffset;
-            sumSquares += current_mA * current_mA;
-            delayMicroseconds(50); // Short delay for sampling (adjust if needed)
-        }
+        static uint16_t window[ADC_SAMPLER_RING_SIZE];
+        uint32_t numSamples = (uint32_t)(_frequency.getPeriodSamples() + 0.5f);
+        if (numSamples > ADC_SAMPLER_RING_SIZE) numSamples = ADC_SAMPLER_RING_SIZE;
+
+        uint32_t head = ADCSampler::head(_acs712Pin);
+        uint32_t cursor = (head > numSamples) ? head - numSamples : 0;
+        size_t n = ADCSampler::readBlocking(_acs712Pin, cursor, window, numSamples);
+        if (n == 0) return 0.0;
 
-        double meanSquare = sumSquares / numSamples;
-        double rms_mA = sqrt(meanSquare);
+        double rms_mA = acs.mA_AC_sampling_buffer(window, n);
         return rms_mA / 1000.0; // Convert mA → A
     }
 
+    struct WindowPower {
+        float real;      // W
+        float apparent;  // VA
+        float vrms;
+        float irms;
+    };
+
+    // Value at a fractional position, linear between neighbours
+    static inline float interpolate(const uint16_t* samples, float position) {
+        int index = (int)position;
+        float fraction = position - index;
+        return samples[index] + (samples[index + 1] - samples[index]) * fraction;
+    }
+
+    // Without a voltage sensor: I x nominal voltage, as apparent power
+    static WindowPower nominalPower(const uint16_t* current, size_t count) {
+        // RMS around the learned midpoint, without the noise floor
+        float current_A = removeNoise(acs.mA_AC_sampling_buffer(current, count)) / 1000.0;
+
+        WindowPower result;
+        result.irms = current_A;
+        result.vrms = _voltageCalibration;
+        result.apparent = result.real = current_A * _voltageCalibration;
+        return result;
+    }
+
+    // Real power as the mean of v x i after phase alignment; both channels
+    // have PHASE_HISTORY older samples in front of the window
+    static WindowPower realPower(const uint16_t* current, const uint16_t* voltage, size_t count) {
+        float currentDelay = _voltageDelay < 0 ? -_voltageDelay : 0;
+        float voltageDelay = _voltageDelay > 0 ? _voltageDelay : 0;
+
+        double sumI = 0, sumV = 0, sumII = 0, sumVV = 0, sumVI = 0;
+        for (size_t n = 0; n < count; n++) {
+            float i = interpolate(current, PHASE_HISTORY + n - currentDelay);
+            float v = interpolate(voltage, PHASE_HISTORY + n - voltageDelay);
+            sumI += i;
+            sumV += v;
+            sumII += i * i;
+            sumVV += v * v;
+            sumVI += v * i;
+        }
+
+        // Remove the DC offsets of both sensors (covariance form)
+        double meanI = sumI / count, meanV = sumV / count;
+        double ampsPerStep = acs.getmAPerStep() / 1000.0;
+        double varI = sumII / count - meanI * meanI;
+        double varV = sumVV / count - meanV * meanV;
+
+        WindowPower result;
+        result.irms = sqrt(varI > 0 ? varI : 0) * ampsPerStep;
+        result.vrms = sqrt(varV > 0 ? varV : 0) * _voltsPerStep;
+        result.real = (sumVI / count - meanI * meanV) * ampsPerStep * _voltsPerStep;
+
+        // Noise does not correlate with the voltage, so only the current
+        // carries the noise floor
+        result.irms = removeNoise(result.irms * 1000.0f) / 1000.0f;
+        result.apparent = result.vrms * result.irms;
+        return result;
+    }
+
+    // Feeds the auto-zero with one cycle: its mean and DC-free deviation
+    static void trackZero(const uint16_t* current, size_t count) {
+        uint32_t sum = 0;
+        uint64_t sumSquares = 0;
+        for (size_t n = 0; n < count; n++) {
+            sum += current[n];
+            sumSquares += (uint32_t)current[n] * current[n];
+        }
+        float mean = (float)sum / count;
+        float variance = (float)sumSquares / count - mean * mean;
+        _zero.addWindow(mean, variance > 0 ? sqrtf(variance) : 0.0f);
+    }
+
+    // Adds power (W) over dt (µs) to the 64-bit accumulator without losing the fraction
+    static void addEnergy(float power, uint32_t dt_us) {
+        _energyRemainder += (uint64_t)(power * 1000.0f + 0.5f) * dt_us; // mW·µs
+        _energy_mWs += _energyRemainder / 1000000ULL;
+        _energyRemainder %= 1000000ULL;
+    }
+
+    // Integrates every full mains cycle collected since the last call.
+    // Windows are one tracked period long; the fractional part of the period
+    // is carried over so they stay aligned to the cycle. The measured elapsed
+    // time is spread over the windows by sample count and each window is
+    // integrated with the trapezoidal rule.
     void update() {
         if (!_sensorConnected) return; // Exit if the sensor is not connected
-        
-        if (millis() - _lastUpdateTime >= 1000) { // Update every second
-            _lastUpdateTime = millis();
-            
-            // Get the AC current from the ACS712 sensor in milliamps
-            int current_mA = acs.mA_AC();
-            
-            // Apply the zero-load offset correction
-            float current_corrected_mA = current_mA - _noLoadOffset;
-            float current_A = (float)current_corrected_mA / 1000.0;
 
-            // Calculate apparent power
-            float power = current_A * _voltageCalibration;
-            
-            // Ensure power doesn't show negative values due to noise
-            if (power < 0) power = 0;
-            if (power > _peakPower) _peakPower = power;
-            
-            // Calculate energy consumed in the last second (Wh)
-            float energy_wh = power * (1.0 / 3600.0);
-            _totalEnergykWh += energy_wh / 1000.0;
+        float period = _frequency.getPeriodSamples();
+        if (_hasVoltage && _frequency.isLocked()) computePhaseDelay();
 
-            _lastSampledPower = power;
+        // Both channels come from the same frames; use what both have delivered
+        uint32_t head = ADCSampler::head(_acs712Pin);
+        if (_hasVoltage) {
+            uint32_t voltageHead = ADCSampler::head(_voltagePin);
+            if ((int32_t)(voltageHead - head) < 0) head = voltageHead;
+        }
+        if (head - _cursor > READABLE_SAMPLES) {
+            // Fell behind: integrate what is left, and keep the gap out of the period
+            uint32_t lost = head - _cursor - READABLE_SAMPLES;
+            _droppedSamples += lost;
+            _frequency.skip(lost);
+            _cursor = head - READABLE_SAMPLES;
         }
-    }
 
-    // void update() {
-    //     if (!_sensorConnected) return;
+        // Lay out the complete cycles first; dt is spread over their total length
+        static uint16_t windowSizes[MAX_WINDOWS];
+        uint32_t windows = 0, totalSamples = 0;
+        float phase = _windowPhase;
+        while (windows < MAX_WINDOWS) {
+            phase += period;
+            uint32_t size = (uint32_t)phase;
+            if (size == 0 || size > READABLE_SAMPLES) size = READABLE_SAMPLES;
+            if (head - _cursor - totalSamples < size) break;
+            phase -= size;
+            windowSizes[windows++] = size;
+            totalSamples += size;
+        }
+        if (windows == 0) return;
+        _windowPhase = phase;
 
-    //     if (millis() - _lastUpdateTime >= 1000) { // Update every second
-    //         _lastUpdateTime = millis();
+        unsigned long now = micros();
+        uint32_t elapsed_us = now - _lastUpdateMicros;
+        _lastUpdateMicros = now;
 
-    //         float current_A = readRMSCurrent(2000);
-    //         if (current_A < 0.05) current_A = 0.0;
+        float powerSum = 0.0, apparentSum = 0.0, vrmsSum = 0.0, irmsSum = 0.0;
+        for (uint32_t w = 0; w < windows; w++) {
+            uint32_t start = _cursor - PHASE_HISTORY;
+            size_t n = ADCSampler::read(_acs712Pin, start, _currentWindow, windowSizes[w] + PHASE_HISTORY);
+            if (n <= PHASE_HISTORY) break;
+            n -= PHASE_HISTORY;
+            const uint16_t* current = _currentWindow + PHASE_HISTORY;
 
-    //         // Calculate apparent power
-    //         float power = current_A * _voltageCalibration;
+            trackZero(current, n);
+            acs.setMidPoint((uint16_t)lroundf(_zero.getMidpoint()));
 
-    //         // Ensure power doesn't show negative values due to noise
-    //         if (power < 0) power = 0;
-    //         if (power > _peakPower) _peakPower = power;
+            WindowPower result;
+            if (_hasVoltage) {
+                start = _cursor - PHASE_HISTORY;
+                ADCSampler::read(_voltagePin, start, _voltageWindow, n + PHASE_HISTORY);
+                result = realPower(_currentWindow, _voltageWindow, n);
+                _frequency.push(_voltageWindow + PHASE_HISTORY, n);
+            } else {
+                result = nominalPower(current, n);
+                _frequency.push(current, n);
+            }
+            _cursor += n;
+            _harmonics.pushCycle(current, n, millis()); // Skips cycles over its budget
 
-    //         // Energy in Wh
-    //         float energy_wh = power * (1.0 / 3600.0);
-    //         _totalEnergykWh += energy_wh / 1000.0;
+            // Ensure power doesn't show negative values due to noise
+            float power = result.real > 0 ? result.real : 0;
+            uint32_t dt_us = (uint64_t)elapsed_us * n / totalSamples;
+
+            addEnergy(0.5f * (_lastWindowPower + power), dt_us);
+            _lastWindowPower = power;
+
+            if (power > _peakPower) _peakPower = power;
+            powerSum += power;
+            apparentSum += result.apparent;
+            vrmsSum += result.vrms;
+            irmsSum += result.irms;
+        }
+
+        _lastSampledPower = powerSum / windows;
+        _lastApparentPower = apparentSum / windows;
+        _lastVrms = vrmsSum / windows;
+        _lastIrms = irmsSum / windows;
+        float reactive = _lastApparentPower * _lastApparentPower - _lastSampledPower * _lastSampledPower;
+        _lastReactivePower = reactive > 0 ? sqrtf(reactive) : 0;
+
+        // Batched: only writes a journal record every few minutes
+        if (_journal != NULL) {
+            _journal->update(_energy_mWs, (uint32_t)(_peakPower * 1000.0), millis());
+        }
+    }
 
-    //         _lastSampledPower = power;
-    //     }
-    // }
-    
     float getCurrent() {
         // Return corrected current in Amps
-        int current_mA = acs.mA_AC();
-        float current_corrected_mA = current_mA - _noLoadOffset;
-        return (float)current_corrected_mA / 1000.0;
-
-        // return readRMSCurrent();    
+        return removeNoise(readRMSCurrent() * 1000.0) / 1000.0;
     }
     
     float getPower() {
         return _lastSampledPower;
     }
     
-    float getCumulativeEnergy() {
-        return _totalEnergykWh;
+    double getCumulativeEnergy() {
+        // 1 kWh = 3.6e9 mWs
+        return _energy_mWs / 3.6e9 + _energyRemainder / 3.6e15;
+    }
+
+    int64_t getEnergyMilliwattSeconds() {
+        return _energy_mWs;
     }
 
     float getPeakPower() {
         return _peakPower;
     }
+
+    uint32_t getDroppedSamples() {
+        return _droppedSamples;
+    }
+
+    bool hasVoltageSensor() {
+        return _hasVoltage;
+    }
+
+    float getVoltage() {
+        return _hasVoltage ? _lastVrms : 0.0f;
+    }
+
+    float getApparentPower() {
+        return _lastApparentPower;
+    }
+
+    float getReactivePower() {
+        return _lastReactivePower;
+    }
+
+    float getPowerFactor() {
+        if (!_hasVoltage || _lastApparentPower <= 0) return 0.0f;
+        float pf = _lastSampledPower / _lastApparentPower;
+        return pf > 1.0f ? 1.0f : pf;
+    }
+
+    void calibrateVoltage(float knownVrms) {
+        if (!_hasVoltage || _lastVrms <= 0) return;
+        _voltsPerStep *= knownVrms / _lastVrms;
+        Serial.printf("✅ New voltage calibration: %.5f V/step\n", _voltsPerStep);
+    }
+
+    float getFrequency() {
+        return _frequency.getFrequency();
+    }
+
+    bool isFrequencyLocked() {
+        return _sensorConnected && _frequency.isLocked();
+    }
+
+    float getCurrentTHD() {
+        return _harmonics.getTHD();
+    }
+
+    float getHarmonicCurrent(uint8_t order) {
+        return _harmonics.getHarmonic(order) * acs.getmAPerStep() / 1000.0f;
+    }
 }
\ No newline at end of file
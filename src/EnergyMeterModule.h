@@ -5,16 +5,62 @@
 #define ENERGYMETER_MODULE_H
 
 #include "ACS712.h"
+#include "FlashStorage.h"
+#include "OffsetTracker.h"
 
 namespace EnergyMeterModule {
     // Public functions for the main application to use
     void begin(int acs712Pin, float voltageCalibration, float sensitivity);
     void update();
     bool isConnected();
-    float getPower();
-    float getCumulativeEnergy();
+    float getPower();                    // W; real power with a voltage sensor
+    double getCumulativeEnergy();        // kWh
+    int64_t getEnergyMilliwattSeconds(); // Exact integrator value
     float getPeakPower();
     float getCurrent();
+
+    // Samples the sampler overwrote before update() integrated them; stays 0
+    // while update() runs well inside a ring (METERING_DRAIN_MS)
+    uint32_t getDroppedSamples();
+
+    // Voltage channel (per-cycle averages of the last update)
+    bool hasVoltageSensor();
+    float getVoltage();                  // Vrms, 0 without a sensor
+    float getApparentPower();            // VA
+    float getReactivePower();            // var (magnitude)
+    float getPowerFactor();              // 0..1, 0 without a sensor
+
+    // Rescales the voltage channel so the present reading equals knownVrms
+    void calibrateVoltage(float knownVrms);
+
+    // Mains frequency tracked from the voltage channel (or the current without
+    // one); nominal 50 Hz until locked. The metering windows follow it.
+    float getFrequency();                // Hz
+    bool isFrequencyLocked();
+
+    // Harmonic content of the load current (updated a few times per second)
+    float getCurrentTHD();                      // % of the fundamental, up to the 15th; -1 at idle
+    float getHarmonicCurrent(uint8_t order);    // A RMS, 1 = fundamental
+
+    // ZMPT101B-style sensor on an ADC1 pin sampled with the current. Must be
+    // called before begin(); phaseDegrees is how far the sensor output lags
+    // the mains voltage. Without a detected sensor the module falls back to
+    // current x voltageCalibration.
+    void setVoltageSensor(int voltagePin, float voltsPerStep, float phaseDegrees);
+
+    // The ACS712 zero (midpoint and noise floor, ADC steps) is learned while
+    // no load runs. restoreZero() starts from a previous boot's values and
+    // must be called before begin(); getZero() is what to persist.
+    void restoreZero(float midpoint, float noise);
+    const OffsetTracker& getZero();
+
+    // Journal backend; defaults to the "energy" partition on the ESP32.
+    // Must be called before begin().
+    void setStorage(FlashStorage* storage);
+
+    // Writes the totals to the journal now; metering task only, other tasks
+    // go through MeteringTask::requestSave()
+    void saveState();
 }
 
 #endif // ENERGYMETER_MODULE_H
@@ -0,0 +1,94 @@
+// FileFlashStorage.cpp
+
+#include "FileFlashStorage.h"
+
+#if !defined(ARDUINO)
+#include <string.h>
+
+FileFlashStorage::FileFlashStorage(const char* path, uint32_t sectorSize, uint32_t sectorCount)
+    : _path(path), _sectorSize(sectorSize), _sectorCount(sectorCount), _file(NULL),
+      _powerLossArmed(false), _powerLost(false), _bytesUntilLoss(0) {}
+
+FileFlashStorage::~FileFlashStorage() {
+    if (_file) fclose(_file);
+}
+
+bool FileFlashStorage::begin() {
+    if (_file) fclose(_file);
+    _file = fopen(_path, "r+b");
+    if (_file == NULL) {
+        // New image: a blank (erased) chip
+        _file = fopen(_path, "w+b");
+        if (_file == NULL) return false;
+        uint8_t blank[256];
+        memset(blank, 0xFF, sizeof(blank));
+        for (uint32_t done = 0; done < size(); done += sizeof(blank)) {
+            fwrite(blank, 1, sizeof(blank), _file);
+        }
+        fflush(_file);
+    }
+    return true;
+}
+
+bool FileFlashStorage::read(uint32_t offset, void* data, size_t length) {
+    if (_file == NULL || _powerLost || offset + length > size()) return false;
+    fseek(_file, offset, SEEK_SET);
+    return fread(data, 1, length, _file) == length;
+}
+
+size_t FileFlashStorage::allowedBytes(size_t length) {
+    if (!_powerLossArmed) return length;
+    if (length <= _bytesUntilLoss) {
+        _bytesUntilLoss -= length;
+        return length;
+    }
+    size_t allowed = _bytesUntilLoss;
+    _bytesUntilLoss = 0;
+    _powerLost = true;
+    return allowed;
+}
+
+bool FileFlashStorage::write(uint32_t offset, const void* data, size_t length) {
+    if (_file == NULL || _powerLost || offset + length > size()) return false;
+
+    uint8_t current[256];
+    const uint8_t* bytes = (const uint8_t*)data;
+    size_t allowed = allowedBytes(length);
+    for (size_t done = 0; done < allowed; ) {
+        size_t chunk = allowed - done < sizeof(current) ? allowed - done : sizeof(current);
+        fseek(_file, offset + done, SEEK_SET);
+        fread(current, 1, chunk, _file);
+        for (size_t i = 0; i < chunk; i++) current[i] &= bytes[done + i]; // NOR: 1 -> 0 only
+        fseek(_file, offset + done, SEEK_SET);
+        fwrite(current, 1, chunk, _file);
+        done += chunk;
+    }
+    fflush(_file);
+    return allowed == length;
+}
+
+bool FileFlashStorage::eraseSector(uint32_t sector) {
+    if (_file == NULL || _powerLost || sector >= _sectorCount) return false;
+
+    uint8_t blank[256];
+    memset(blank, 0xFF, sizeof(blank));
+    size_t allowed = allowedBytes(_sectorSize);
+    fseek(_file, sector * _sectorSize, SEEK_SET);
+    for (size_t done = 0; done < allowed; done += sizeof(blank)) {
+        size_t chunk = allowed - done < sizeof(blank) ? allowed - done : sizeof(blank);
+        fwrite(blank, 1, chunk, _file);
+    }
+    fflush(_file);
+    return allowed == _sectorSize;
+}
+
+void FileFlashStorage::simulatePowerLoss(uint32_t bytes) {
+    _powerLossArmed = true;
+    _bytesUntilLoss = bytes;
+}
+
+void FileFlashStorage::powerCycle() {
+    _powerLossArmed = false;
+    _powerLost = false;
+}
+#endif
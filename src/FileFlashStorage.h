@@ -0,0 +1,44 @@
+// FileFlashStorage.h
+
+#ifndef FILE_FLASH_STORAGE_H
+#define FILE_FLASH_STORAGE_H
+
+#include "FlashStorage.h"
+
+#if !defined(ARDUINO)
+#include <stdio.h>
+
+// FlashStorage backed by an image file for Linux builds. Emulates NOR
+// semantics and can cut the power after a number of bytes to test recovery.
+class FileFlashStorage : public FlashStorage {
+public:
+    FileFlashStorage(const char* path, uint32_t sectorSize, uint32_t sectorCount);
+    ~FileFlashStorage();
+
+    bool begin() override;
+    uint32_t sectorSize() const override { return _sectorSize; }
+    uint32_t sectorCount() const override { return _sectorCount; }
+
+    bool read(uint32_t offset, void* data, size_t length) override;
+    bool write(uint32_t offset, const void* data, size_t length) override;
+    bool eraseSector(uint32_t sector) override;
+
+    // Only the next `bytes` bytes of writes/erases reach the image, then
+    // every operation fails until powerCycle()
+    void simulatePowerLoss(uint32_t bytes);
+    void powerCycle();
+
+private:
+    size_t allowedBytes(size_t length);
+
+    const char* _path;
+    uint32_t _sectorSize;
+    uint32_t _sectorCount;
+    FILE* _file;
+    bool _powerLossArmed;
+    bool _powerLost;
+    uint32_t _bytesUntilLoss;
+};
+#endif
+
+#endif // FILE_FLASH_STORAGE_H
@@ -0,0 +1,26 @@
+// FlashStorage.h
+
+#ifndef FLASH_STORAGE_H
+#define FLASH_STORAGE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Raw NOR flash region: erase sets a sector to 0xFF, writes can only clear bits.
+// Implemented by an ESP32 partition on the device and a file image on Linux.
+class FlashStorage {
+public:
+    virtual ~FlashStorage() {}
+
+    virtual bool begin() = 0;
+    virtual uint32_t sectorSize() const = 0;
+    virtual uint32_t sectorCount() const = 0;
+
+    virtual bool read(uint32_t offset, void* data, size_t length) = 0;
+    virtual bool write(uint32_t offset, const void* data, size_t length) = 0;
+    virtual bool eraseSector(uint32_t sector) = 0;
+
+    uint32_t size() const { return sectorSize() * sectorCount(); }
+};
+
+#endif // FLASH_STORAGE_H
@@ -0,0 +1,127 @@
+// FrequencyTracker.cpp
+
+#include "FrequencyTracker.h"
+
+#define FREQUENCY_SMOOTHING 0.1f  // Weight of a new period
+#define FREQUENCY_TOLERANCE 0.05f // Max deviation of a cycle once locked
+
+FrequencyTracker::FrequencyTracker() {
+    begin(10000);
+}
+
+void FrequencyTracker::begin(uint32_t sampleRateHz, float nominalHz) {
+    _sampleRate = sampleRateHz;
+    _nominalPeriod = sampleRateHz / nominalHz;
+    _minPeriod = sampleRateHz / FREQUENCY_MAX_HZ;
+    _maxPeriod = sampleRateHz / FREQUENCY_MIN_HZ;
+    _period = _nominalPeriod;
+    _offset = 0;
+    _amplitude = 0;
+    _previous = 0;
+    _armed = false;
+    _hasCandidate = false;
+    _candidate = 0;
+    _hasOffset = false;
+    _index = 0;
+    _lastCrossing = 0;
+    _hasCrossing = false;
+    _goodCycles = 0;
+    _badInRow = 0;
+    _rejected = 0;
+}
+
+void FrequencyTracker::push(const uint16_t* samples, size_t count) {
+    if (count == 0) return;
+    if (!_hasOffset) {
+        // Start from the mean of the first chunk
+        uint32_t sum = 0;
+        for (size_t i = 0; i < count; i++) sum += samples[i];
+        _offset = (float)sum / count;
+        _previous = samples[0] - _offset;
+        _hasOffset = true;
+        for (uint8_t i = 0; i < FREQUENCY_FILTER_TAPS; i++) _filter[i] = samples[0];
+        _filterSum = (uint32_t)samples[0] * FREQUENCY_FILTER_TAPS;
+        _filterIndex = 0;
+    }
+
+    // The DC level and amplitude follow over a few cycles
+    const float follow = 4.0f / _nominalPeriod / 8.0f;
+    for (size_t i = 0; i < count; i++, _index++) {
+        // Boxcar low-pass against ADC noise; its fixed delay cancels in the period
+        _filterSum += samples[i] - _filter[_filterIndex];
+        _filter[_filterIndex] = samples[i];
+        _filterIndex = (_filterIndex + 1) % FREQUENCY_FILTER_TAPS;
+
+        float x = (float)_filterSum / FREQUENCY_FILTER_TAPS - _offset;
+        _offset += x * follow;
+        _amplitude += (fabsf(x) - _amplitude) * follow;
+
+        // Schmitt trigger: arm below -h, fire above +h at the last zero crossing
+        float hysteresis = _amplitude * 0.5f;
+        if (hysteresis < 4.0f) hysteresis = 4.0f;
+        if (x < -hysteresis) {
+            _armed = true;
+            _hasCandidate = false;
+        } else if (_armed) {
+            if (_previous < 0 && x >= 0) {
+                // Linear interpolation between the two samples around zero
+                _candidate = _index - 1 + (double)(-_previous) / (x - _previous);
+                _hasCandidate = true;
+            }
+            if (x > hysteresis && _hasCandidate) {
+                crossing(_candidate);
+                _armed = false;
+            }
+        }
+        _previous = x;
+    }
+}
+
+void FrequencyTracker::skip(size_t count) {
+    _index += count;
+    _hasOffset = false; // Refill the filter from the next chunk
+    _armed = false;
+    _hasCandidate = false;
+    _hasCrossing = false;
+}
+
+void FrequencyTracker::crossing(double position) {
+    if (!_hasCrossing) {
+        _hasCrossing = true;
+        _lastCrossing = position;
+        return;
+    }
+
+    float period = position - _lastCrossing;
+    _lastCrossing = position;
+
+    bool plausible = period >= _minPeriod && period <= _maxPeriod;
+    if (plausible && isLocked()) {
+        plausible = fabsf(period - _period) <= _period * FREQUENCY_TOLERANCE;
+    }
+    if (!plausible) {
+        _rejected++;
+        // Lost the signal (or the frequency really jumped): start over
+        if (++_badInRow >= FREQUENCY_LOCK_CYCLES) {
+            _goodCycles = 0;
+            _badInRow = 0;
+        }
+        return;
+    }
+
+    _badInRow = 0;
+    if (_goodCycles == 0) {
+        _period = period;
+    } else {
+        _period += (period - _period) * FREQUENCY_SMOOTHING;
+    }
+    if (_goodCycles < 255) _goodCycles++;
+}
+
+float FrequencyTracker::getPeriodSamples() const {
+    return isLocked() ? _period : _nominalPeriod;
+}
+
+float FrequencyTracker::getFrequency() const {
+    return _sampleRate / getPeriodSamples();
+}
@@ -0,0 +1,64 @@
+// FrequencyTracker.h
+
+#ifndef FREQUENCY_TRACKER_H
+#define FREQUENCY_TRACKER_H
+
+#include <Arduino.h>
+
+#define FREQUENCY_MIN_HZ     40.0f
+#define FREQUENCY_MAX_HZ     70.0f
+#define FREQUENCY_LOCK_CYCLES 5   // Consistent cycles before the estimate is used
+#define FREQUENCY_FILTER_TAPS 8   // Moving average before the crossing detector
+
+// Streaming mains frequency estimate from rising zero crossings. Crossing
+// times are interpolated between samples, so the period has sub-sample
+// resolution; it is smoothed and implausible cycles are rejected.
+class FrequencyTracker {
+public:
+    FrequencyTracker();
+
+    void begin(uint32_t sampleRateHz, float nominalHz = 50.0f);
+
+    // Raw ADC samples in order, in chunks of any size
+    void push(const uint16_t* samples, size_t count);
+
+    // Samples that were lost: the next crossing starts a new period instead
+    // of measuring one across the gap. The lock is kept.
+    void skip(size_t count);
+
+    // Tracked frequency, or the nominal one until locked
+    float getFrequency() const;
+
+    // Mains period in samples (fractional)
+    float getPeriodSamples() const;
+
+    bool isLocked() const { return _goodCycles >= FREQUENCY_LOCK_CYCLES; }
+    uint32_t getRejectedCycles() const { return _rejected; }
+
+private:
+    void crossing(double position);
+
+    uint32_t _sampleRate;
+    float _nominalPeriod;
+    float _minPeriod;
+    float _maxPeriod;
+    float _period;            // Smoothed, in samples
+    float _offset;            // Running DC level
+    float _amplitude;         // Running mean |x - offset|, sets the hysteresis
+    uint16_t _filter[FREQUENCY_FILTER_TAPS];
+    uint32_t _filterSum;
+    uint8_t _filterIndex;
+    float _previous;          // Last centred sample
+    bool _armed;              // Went below -hysteresis since the last crossing
+    bool _hasCandidate;
+    double _candidate;        // Last upward zero crossing while armed
+    bool _hasOffset;
+    uint64_t _index;          // Samples seen
+    double _lastCrossing;
+    bool _hasCrossing;
+    uint8_t _goodCycles;
+    uint8_t _badInRow;
+    uint32_t _rejected;
+};
+
+#endif // FREQUENCY_TRACKER_H
@@ -0,0 +1,129 @@
+// HarmonicAnalyzer.cpp
+
+#include "HarmonicAnalyzer.h"
+
+#if defined(ESP32) && __has_include(<esp_dsp.h>)
+#include <esp_dsp.h>
+#define HARMONIC_USE_ESP_DSP
+#endif
+
+// Interleaved re/im work buffer, shared by all analyzers (one FFT at a time)
+static float _fft[HARMONIC_FFT_SIZE * 2] __attribute__((aligned(16)));
+static bool _fftReady = false;
+
+#if defined(HARMONIC_USE_ESP_DSP)
+static bool fftInit() {
+    return dsps_fft2r_init_fc32(NULL, HARMONIC_FFT_SIZE) == ESP_OK;
+}
+
+static void fftRun() {
+    dsps_fft2r_fc32(_fft, HARMONIC_FFT_SIZE);
+    dsps_bit_rev_fc32(_fft, HARMONIC_FFT_SIZE);
+}
+#else
+static float _twiddle[HARMONIC_FFT_SIZE]; // cos/sin pairs for k < N/2
+
+static bool fftInit() {
+    for (int k = 0; k < HARMONIC_FFT_SIZE / 2; k++) {
+        _twiddle[2 * k] = cosf(2.0f * M_PI * k / HARMONIC_FFT_SIZE);
+        _twiddle[2 * k + 1] = -sinf(2.0f * M_PI * k / HARMONIC_FFT_SIZE);
+    }
+    return true;
+}
+
+// Iterative in-place radix-2 decimation-in-time FFT
+static void fftRun() {
+    const int n = HARMONIC_FFT_SIZE;
+    for (int i = 1, j = 0; i < n; i++) {
+        int bit = n >> 1;
+        for (; j & bit; bit >>= 1) j ^= bit;
+        j ^= bit;
+        if (i < j) {
+            float re = _fft[2 * i], im = _fft[2 * i + 1];
+            _fft[2 * i] = _fft[2 * j];
+            _fft[2 * i + 1] = _fft[2 * j + 1];
+            _fft[2 * j] = re;
+            _fft[2 * j + 1] = im;
+        }
+    }
+    for (int length = 2; length <= n; length <<= 1) {
+        int step = n / length;
+        for (int start = 0; start < n; start += length) {
+            for (int k = 0; k < length / 2; k++) {
+                float wr = _twiddle[2 * k * step], wi = _twiddle[2 * k * step + 1];
+                float* a = &_fft[2 * (start + k)];
+                float* b = &_fft[2 * (start + k + length / 2)];
+                float tr = b[0] * wr - b[1] * wi;
+                float ti = b[0] * wi + b[1] * wr;
+                b[0] = a[0] - tr;
+                b[1] = a[1] - ti;
+                a[0] += tr;
+                a[1] += ti;
+            }
+        }
+    }
+}
+#endif
+
+HarmonicAnalyzer::HarmonicAnalyzer()
+    : _smoothing(0.25f), _minIntervalMs(200), _lastMs(0), _analyzed(0), _lastAnalysisUs(0) {
+    memset(_harmonics, 0, sizeof(_harmonics));
+}
+
+void HarmonicAnalyzer::begin(uint8_t maxCyclesPerSecond, float smoothing) {
+    _minIntervalMs = maxCyclesPerSecond ? 1000 / maxCyclesPerSecond : 1000;
+    _smoothing = constrain(smoothing, 0.01f, 1.0f);
+    _analyzed = 0;
+    memset(_harmonics, 0, sizeof(_harmonics));
+    if (!_fftReady) _fftReady = fftInit();
+}
+
+bool HarmonicAnalyzer::pushCycle(const uint16_t* samples, size_t count, uint32_t nowMs) {
+    if (!_fftReady || count < 8) return false;
+    if (_analyzed > 0 && nowMs - _lastMs < _minIntervalMs) return false;
+    _lastMs = nowMs;
+
+    unsigned long start = micros();
+    analyze(samples, count);
+    _lastAnalysisUs = micros() - start;
+    _analyzed++;
+    return true;
+}
+
+void HarmonicAnalyzer::analyze(const uint16_t* samples, size_t count) {
+    // Resample the cycle to N points (linear interpolation) and remove the mean
+    float mean = 0;
+    for (int i = 0; i < HARMONIC_FFT_SIZE; i++) {
+        float position = (float)i * count / HARMONIC_FFT_SIZE;
+        size_t index = (size_t)position;
+        float fraction = position - index;
+        float next = samples[index + 1 < count ? index + 1 : 0]; // Wrap: the cycle repeats
+        float value = samples[index] + (next - samples[index]) * fraction;
+        _fft[2 * i] = value;
+        _fft[2 * i + 1] = 0;
+        mean += value;
+    }
+    mean /= HARMONIC_FFT_SIZE;
+    for (int i = 0; i < HARMONIC_FFT_SIZE; i++) _fft[2 * i] -= mean;
+
+    fftRun();
+
+    // Bin k of one cycle is harmonic k; RMS = sqrt(2) * |X_k| / N
+    const float scale = sqrtf(2.0f) / HARMONIC_FFT_SIZE;
+    for (int k = 1; k <= HARMONIC_MAX_ORDER; k++) {
+        float magnitude = sqrtf(_fft[2 * k] * _fft[2 * k] + _fft[2 * k + 1] * _fft[2 * k + 1]) * scale;
+        _harmonics[k] = _analyzed == 0 ? magnitude : _harmonics[k] + _smoothing * (magnitude - _harmonics[k]);
+    }
+}
+
+float HarmonicAnalyzer::getHarmonic(uint8_t order) const {
+    if (order < 1 || order > HARMONIC_MAX_ORDER) return 0.0f;
+    return _harmonics[order];
+}
+
+float HarmonicAnalyzer::getTHD() const {
+    if (_harmonics[1] < HARMONIC_MIN_FUNDAMENTAL) return -1.0f;
+    float sum = 0;
+    for (int k = 2; k <= HARMONIC_MAX_ORDER; k++) sum += _harmonics[k] * _harmonics[k];
+    return sqrtf(sum) / _harmonics[1] * 100.0f;
+}
@@ -0,0 +1,48 @@
+// HarmonicAnalyzer.h
+
+#ifndef HARMONIC_ANALYZER_H
+#define HARMONIC_ANALYZER_H
+
+#include <Arduino.h>
+
+#define HARMONIC_FFT_SIZE  128 // Points per resampled mains cycle
+#define HARMONIC_MAX_ORDER 15
+#define HARMONIC_MIN_FUNDAMENTAL 10.0f // ADC steps RMS (~45 mA on a 5 A ACS712); below it THD is noise
+
+// Harmonic content of a periodic current. Each analyzed block is one whole
+// mains cycle, resampled to HARMONIC_FFT_SIZE points so bin k is harmonic k.
+// Uses the ESP-DSP radix-2 FFT on the ESP32 and a portable one elsewhere.
+// Only a few cycles per second are analyzed, which bounds the CPU time.
+class HarmonicAnalyzer {
+public:
+    HarmonicAnalyzer();
+
+    // maxCyclesPerSecond bounds the work; smoothing is the weight of a new
+    // cycle in the running averages (1 = no averaging)
+    void begin(uint8_t maxCyclesPerSecond = 5, float smoothing = 0.25f);
+
+    // Offers one whole cycle of raw samples; true when it was analyzed
+    bool pushCycle(const uint16_t* samples, size_t count, uint32_t nowMs);
+
+    // RMS of harmonic `order` (1 = fundamental) in ADC steps
+    float getHarmonic(uint8_t order) const;
+
+    // Total harmonic distortion up to HARMONIC_MAX_ORDER, % of the fundamental;
+    // -1 while the fundamental is below HARMONIC_MIN_FUNDAMENTAL (idle load)
+    float getTHD() const;
+
+    uint32_t getAnalyzedCycles() const { return _analyzed; }
+    uint32_t getLastAnalysisMicros() const { return _lastAnalysisUs; }
+
+private:
+    void analyze(const uint16_t* samples, size_t count);
+
+    float _harmonics[HARMONIC_MAX_ORDER + 1]; // Smoothed RMS, index = order
+    float _smoothing;
+    uint32_t _minIntervalMs;
+    uint32_t _lastMs;
+    uint32_t _analyzed;
+    uint32_t _lastAnalysisUs;
+};
+
+#endif // HARMONIC_ANALYZER_H
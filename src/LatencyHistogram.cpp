@@ -0,0 +1,50 @@
+// LatencyHistogram.cpp
+
+#include "LatencyHistogram.h"
+
+// Values below 4 us get their own bucket; above that each octave is split in four
+uint8_t LatencyHistogram::bucketOf(uint32_t us) {
+    if (us < LATENCY_SUB_BUCKETS) return us;
+    uint8_t exponent = 31 - __builtin_clz(us);
+    uint8_t sub = (us >> (exponent - 2)) & (LATENCY_SUB_BUCKETS - 1);
+    uint32_t bucket = (exponent - 1) * LATENCY_SUB_BUCKETS + sub;
+    return bucket < LATENCY_BUCKETS ? bucket : LATENCY_BUCKETS - 1;
+}
+
+uint32_t LatencyHistogram::bucketLowerBound(uint8_t bucket) {
+    if (bucket < LATENCY_SUB_BUCKETS) return bucket;
+    uint8_t exponent = bucket / LATENCY_SUB_BUCKETS + 1;
+    uint8_t sub = bucket % LATENCY_SUB_BUCKETS;
+    return (uint32_t)(LATENCY_SUB_BUCKETS + sub) << (exponent - 2);
+}
+
+void LatencyHistogram::record(uint32_t us) {
+    _buckets[bucketOf(us)]++;
+    _count++;
+    _total += us;
+    if (us > _max) _max = us;
+}
+
+void LatencyHistogram::reset() {
+    memset(_buckets, 0, sizeof(_buckets));
+    _count = 0;
+    _max = 0;
+    _total = 0;
+}
+
+uint32_t LatencyHistogram::percentile(float pct) const {
+    if (_count == 0) return 0;
+    uint32_t rank = (uint32_t)ceilf(_count * pct / 100.0f);
+    if (rank == 0) rank = 1;
+
+    uint32_t seen = 0;
+    for (uint8_t b = 0; b < LATENCY_BUCKETS; b++) {
+        seen += _buckets[b];
+        if (seen >= rank) {
+            if (b + 1 >= LATENCY_BUCKETS) return _max;
+            uint32_t upper = bucketLowerBound(b + 1) - 1;
+            return upper < _max ? upper : _max;
+        }
+    }
+    return _max;
+}
@@ -0,0 +1,38 @@
+// LatencyHistogram.h
+
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <Arduino.h>
+
+// 4 buckets per power of two up to 2^25 us (~33 s); larger values land in the last one
+#define LATENCY_SUB_BUCKETS 4
+#define LATENCY_BUCKETS     96
+
+// Fixed-size log-scale histogram of durations in microseconds. Recording is
+// O(1) with no heap; percentiles are accurate to one bucket (about 19%).
+class LatencyHistogram {
+public:
+    LatencyHistogram() { reset(); }
+
+    void record(uint32_t us);
+    void reset();
+
+    // Upper bound of the bucket holding the given percentile (0-100), capped at max
+    uint32_t percentile(float pct) const;
+
+    uint32_t getCount() const { return _count; }
+    uint32_t getMax() const { return _max; }
+    uint32_t getMean() const { return _count ? (uint32_t)(_total / _count) : 0; }
+
+    static uint8_t bucketOf(uint32_t us);
+    static uint32_t bucketLowerBound(uint8_t bucket);
+
+private:
+    uint32_t _buckets[LATENCY_BUCKETS];
+    uint32_t _count;
+    uint32_t _max;
+    uint64_t _total;
+};
+
+#endif // LATENCY_HISTOGRAM_H
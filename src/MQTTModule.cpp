@@ -1,49 +1,86 @@
 
 // MQTTModule.cpp
 #include "MQTTModule.h"
+#include <WiFiClientSecure.h>
 #include <ArduinoJson.h>
 
 namespace MQTTModule {
     static WiFiClient espClient;
+    static WiFiClientSecure espSecureClient;
     static PubSubClient client(espClient);
     static const char* _deviceId;
-    static unsigned long _lastReconnectAttempt = 0;
+    static const char* _username = NULL;
+    static const char* _password = NULL;
+    static volatile bool _online = false; // Hands the client from connect() to loop()
 
 
-    void begin(const char* server, int port, const char* deviceId) {
+    void begin(const char* server, int port, const char* deviceId, const char* username, const char* password) {
         _deviceId = deviceId;
+        _username = username;
+        _password = password;
+        if (port == 8883) {
+            // Broker certificate is not pinned; the link is still encrypted
+            espSecureClient.setInsecure();
+            client.setClient(espSecureClient);
+        }
         client.setServer(server, port);
     }
 
-    void connect() {
-        if (!client.connected()) {
-            if (millis() - _lastReconnectAttempt > 5000) {
-                _lastReconnectAttempt = millis();
-                Serial.print("Attempting MQTT connection...");
-                String clientId = String(_deviceId) + "_" + String(random(0xffff), HEX);
-                if (client.connect(clientId.c_str())) {
-                    Serial.println("connected");
-                    String ctl = "home_iot/" + String(_deviceId) + "/control";
-                    client.subscribe(ctl.c_str());
-                    String stat = "home_iot/" + String(_deviceId) + "/status";
-                    client.publish(stat.c_str(), "{\"status\":\"online\"}");
-                } else {
-                    Serial.print("failed, rc=");
-                    Serial.print(client.state());
-                    Serial.println(" try again in 5 seconds");
-                }
-            }
+    bool connect() {
+        if (_online) return true;
+        Serial.print("Attempting MQTT connection...");
+        String clientId = String(_deviceId) + "_" + String(random(0xffff), HEX);
+        if (client.connect(clientId.c_str(), _username, _password)) {
+            Serial.println("connected");
+            String ctl = "home_iot/" + String(_deviceId) + "/control";
+            client.subscribe(ctl.c_str());
+            String stat = "home_iot/" + String(_deviceId) + "/status";
+            client.publish(stat.c_str(), "{\"status\":\"online\"}");
+            _online = true;
+            return true;
         }
+        Serial.print("failed, rc=");
+        Serial.println(client.state());
+        return false;
     }
 
     void loop() {
-        if (!client.connected()) connect();
+        if (!_online) return;
+        if (WiFi.status() != WL_CONNECTED) {
+            // The socket can look open long after the link is gone; drop it
+            // so the next connect() really reconnects
+            client.disconnect();
+            _online = false; // The connectivity task takes over
+            Serial.println("⚠️ MQTT offline: WiFi lost.");
+            return;
+        }
+        if (!client.connected()) {
+            _online = false; // The connectivity task takes over
+            Serial.println("⚠️ MQTT connection lost.");
+            return;
+        }
         client.loop();
     }
 
-    void publish(const char* topic, const char* payload) {
-        if (!client.connected()) return;
-        client.publish(topic, payload);
-        Serial.println("Published: " + String(payload));
+    bool publish(const char* topic, const char* payload) {
+        return publish(topic, (const uint8_t*)payload, strlen(payload));
+    }
+
+    bool publish(const char* topic, const uint8_t* payload, size_t length) {
+        if (!isConnected()) return false;
+        return client.publish(topic, payload, length);
+    }
+
+    bool isConnected() {
+        // WiFi is checked too, so callers see an outage before loop() runs
+        return _online && WiFi.status() == WL_CONNECTED;
+    }
+
+    bool setBufferSize(uint16_t size) {
+        return client.setBufferSize(size);
+    }
+
+    const char* getDeviceId() {
+        return _deviceId;
     }
 }
@@ -6,10 +6,23 @@
 #include <WiFi.h>
 
 namespace MQTTModule {
-    void begin(const char* server, int port, const char* deviceId);
+    // Port 8883 uses TLS; username/password are optional
+    void begin(const char* server, int port, const char* deviceId,
+               const char* username = NULL, const char* password = NULL);
+    // Serves the session; only does work while connected
     void loop();
-    void publish(const char* topic, const char* payload);
-    void connect();
+    bool publish(const char* topic, const char* payload);
+    bool publish(const char* topic, const uint8_t* payload, size_t length);
+
+    // One blocking connection attempt (TLS, login, subscribe); run it from
+    // the connectivity task, never next to loop()/publish()
+    bool connect();
+
+    // Session flag and WiFi link, safe from any task; the flag is cleared by
+    // loop() when the broker or WiFi drops
+    bool isConnected();
+    bool setBufferSize(uint16_t size);
+    const char* getDeviceId();
 }
 
 #endif
@@ -0,0 +1,133 @@
+// MeteringTask.cpp
+
+#include "MeteringTask.h"
+#include "SPSCQueue.h"
+#include "WaterLevelMonitor.h"
+#include "EnergyMeterModule.h"
+#include "CTManager.h"
+#include "Scheduler.h"
+
+namespace MeteringTask {
+    static SPSCQueue<MeasurementFrame, 8> _queue;
+    static MeasurementFrame _snapshot = { 0, 0, -1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+    static bool _hasWaterSensor = false;
+    static bool _hasEnergyMeter = false;
+    static bool _hasCT = false;
+    static uint32_t _periodMs = 250;
+    static volatile uint32_t _droppedFrames = 0;
+    static volatile bool _saveRequested = false;
+    static volatile bool _saved = false;
+
+    static Scheduler _scheduler("metering");
+    static uint32_t _sequence = 0;
+
+    // --- Jobs; everything here belongs to the metering task ---
+
+    // The sonar is non-blocking and decides itself when the next reading is due
+    static void sonarJob() {
+        WaterLevelMonitor::update();
+    }
+
+    static void energyJob() {
+        EnergyMeterModule::update();
+    }
+
+    static void ctJob() {
+        // Same cycle boundaries as the ACS712 windows once the frequency is known
+        bool locked = _hasEnergyMeter && EnergyMeterModule::isFrequencyLocked();
+        CTManager::setMainsFrequency(locked ? EnergyMeterModule::getFrequency() : 0.0f);
+        CTManager::update();
+    }
+
+    // Collects the latest results into one frame for loop()
+    static void frameJob() {
+        MeasurementFrame frame;
+        frame.waterLevelCm = -1.0f;
+        frame.waterLevelPercent = -1.0f;
+        if (_hasWaterSensor) {
+            frame.waterLevelCm = WaterLevelMonitor::getLevel();
+            frame.waterLevelPercent = WaterLevelMonitor::getLevelPercent();
+        }
+
+        frame.power = EnergyMeterModule::getPower();
+        frame.apparentPower = EnergyMeterModule::getApparentPower();
+        frame.reactivePower = EnergyMeterModule::getReactivePower();
+        frame.powerFactor = EnergyMeterModule::getPowerFactor();
+        frame.voltage = EnergyMeterModule::getVoltage();
+        frame.peakPower = EnergyMeterModule::getPeakPower();
+        frame.energyKWh = EnergyMeterModule::getCumulativeEnergy();
+        frame.currentTHD = EnergyMeterModule::getCurrentTHD();
+        frame.frequency = EnergyMeterModule::isFrequencyLocked() ? EnergyMeterModule::getFrequency() : 0.0f;
+        frame.ctChannels = _hasCT ? CTManager::getChannelCount() : 0;
+        for (uint8_t c = 0; c < CT_MAX_CHANNELS; c++) {
+            frame.ctCurrents[c] = c < frame.ctChannels ? CTManager::getCurrent(c) : 0.0f;
+        }
+        frame.ctCurrent = frame.ctCurrents[0];
+
+        frame.sequence = ++_sequence;
+        frame.timestampMs = millis();
+        if (!_queue.push(frame)) _droppedFrames++;
+    }
+
+    static void meteringTask(void*) {
+        for (;;) {
+            _scheduler.run(10);
+            if (_saveRequested) {
+                _saveRequested = false;
+                if (_hasEnergyMeter) EnergyMeterModule::saveState();
+                _saved = true;
+            }
+        }
+    }
+
+    void begin(bool waterSensor, bool energyMeter, bool ct, uint32_t periodMs) {
+        _hasWaterSensor = waterSensor;
+        _hasEnergyMeter = energyMeter;
+        _hasCT = ct;
+        _periodMs = periodMs;
+
+        // The measurements drain the ring at least every METERING_DRAIN_MS; the
+        // frame job has the latest deadline so it runs after the sensors
+        // released together with it
+        uint32_t drainMs = min(_periodMs, (uint32_t)METERING_DRAIN_MS);
+        if (_hasWaterSensor) _scheduler.addJob("sonar", sonarJob, 10, 10, 500);
+        if (_hasEnergyMeter) _scheduler.addJob("acs712", energyJob, drainMs, drainMs / 2, 5000);
+        if (_hasCT) _scheduler.addJob("ct", ctJob, drainMs, drainMs / 2, 5000);
+        _scheduler.addJob("frame", frameJob, _periodMs, _periodMs, 500);
+
+        // Arduino loop() runs on core 1, so metering gets core 0 to itself
+        xTaskCreatePinnedToCore(meteringTask, "metering", 6144, NULL, 3, NULL, 0);
+        Serial.printf("⏱️ Metering task started (every %lu ms on core 0)\n", (unsigned long)_periodMs);
+    }
+
+    bool poll() {
+        bool updated = false;
+        MeasurementFrame frame;
+        while (_queue.pop(frame)) {
+            _snapshot = frame;
+            updated = true;
+        }
+        return updated;
+    }
+
+    const MeasurementFrame& snapshot() {
+        return _snapshot;
+    }
+
+    uint32_t getDroppedFrames() {
+        return _droppedFrames;
+    }
+
+    void requestSave() {
+        _saved = false;
+        _saveRequested = true;
+    }
+
+    bool isSaved() {
+        return _saved;
+    }
+
+    const Scheduler& getScheduler() {
+        return _scheduler;
+    }
+}
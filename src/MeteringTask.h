@@ -0,0 +1,60 @@
+// MeteringTask.h
+
+#ifndef METERING_TASK_H
+#define METERING_TASK_H
+
+#include <Arduino.h>
+#include "CTManager.h"
+#include "Scheduler.h"
+
+// The acs712 and ct jobs drain the sampler ring (204.8 ms at 10 kHz) this
+// often, whatever the frame period, so no sample is overwritten unread
+#define METERING_DRAIN_MS 100
+
+// One timestamped set of measurements produced by the metering task
+struct MeasurementFrame {
+    uint32_t sequence;
+    uint32_t timestampMs;
+    float waterLevelCm;      // -1 when there is no reading
+    float waterLevelPercent; // -1 when there is no reading
+    float power;             // W (real power with a voltage sensor)
+    float apparentPower;     // VA
+    float reactivePower;     // var
+    float powerFactor;       // 0 without a voltage sensor
+    float voltage;           // Vrms, 0 without a voltage sensor
+    float frequency;         // Hz, 0 until the tracker locks
+    float peakPower;         // W
+    double energyKWh;
+    float currentTHD;        // % of the fundamental, -1 when the load is too small
+    float ctCurrent;         // A, main CT (CTManager channel 0)
+    uint8_t ctChannels;      // Circuits in ctCurrents
+    float ctCurrents[CT_MAX_CHANNELS]; // A, per CTManager channel
+};
+
+namespace MeteringTask {
+    // Starts the measurement task on core 0 for the connected modules.
+    // Sonar, ACS712, CT and frame assembly are scheduled as separate jobs;
+    // the CT job updates every CTManager channel.
+    void begin(bool waterSensor, bool energyMeter, bool ct, uint32_t periodMs);
+
+    // Drains the frame queue; returns true when a newer frame arrived.
+    // Must only be called from one task (the Arduino loop).
+    bool poll();
+
+    // Latest frame received by poll()
+    const MeasurementFrame& snapshot();
+
+    // Frames dropped because the consumer fell behind
+    uint32_t getDroppedFrames();
+
+    // Asks the metering task to write the energy journal now, e.g. before a
+    // planned reboot; the journal is the task's own, so nobody else may.
+    // isSaved() turns true once the record is written.
+    void requestSave();
+    bool isSaved();
+
+    // Job table of the metering task (read-only, for diagnostics)
+    const Scheduler& getScheduler();
+}
+
+#endif // METERING_TASK_H
@@ -0,0 +1,265 @@
+// MetricHistory.cpp
+
+#include "MetricHistory.h"
+
+#define HISTORY_EMPTY 0xFFFF // Encoded mean of a bucket without samples
+
+namespace MetricHistory {
+    // 16-bit fixed point, clamped below HISTORY_EMPTY
+    struct Bucket {
+        uint16_t min;
+        uint16_t max;
+        uint16_t mean;
+        uint16_t last;
+    };
+
+    struct Accumulator {
+        float sum;
+        uint32_t count;
+        float min;
+        float max;
+        float last;
+    };
+
+    struct Tier {
+        uint32_t resolution;   // Seconds per bucket
+        uint16_t capacity;
+        Bucket* slots;         // capacity x HISTORY_METRICS, bucket number % capacity
+        uint32_t first;        // First bucket number recorded
+        uint32_t open;         // Bucket number being accumulated
+        Accumulator pending[HISTORY_METRICS];
+    };
+
+    static const char* METRIC_NAMES[HISTORY_METRICS] = { "power", "current", "level" };
+    static const float METRIC_SCALES[HISTORY_METRICS] = {
+        0.1f,   // W, up to 6.5 kW
+        0.001f, // A, up to 65 A
+        0.01f,  // %, up to 655 %
+    };
+
+    static Bucket _seconds[HISTORY_SECONDS_BUCKETS * HISTORY_METRICS];
+    static Bucket _minutes[HISTORY_MINUTES_BUCKETS * HISTORY_METRICS];
+    static Bucket _hours[HISTORY_HOURS_BUCKETS * HISTORY_METRICS];
+
+    static Tier _tiers[HISTORY_TIERS] = {
+        { 1,    HISTORY_SECONDS_BUCKETS, _seconds, 0, 0, {} },
+        { 60,   HISTORY_MINUTES_BUCKETS, _minutes, 0, 0, {} },
+        { 3600, HISTORY_HOURS_BUCKETS,   _hours,   0, 0, {} },
+    };
+
+    static bool _started = false;
+    static uint64_t _clockMs = 0;           // Extended millis(), survives the 49-day wrap
+    static uint32_t _lastTimestampMs = 0;
+
+    // The web server reads from the AsyncTCP task, which outranks loop():
+    // a retry loop could spin while record() is preempted mid-write, so
+    // writes and copies take a spinlock instead. Each section is short (one
+    // tier's update, one bucket's copy).
+#if defined(ESP32)
+    static portMUX_TYPE _lock = portMUX_INITIALIZER_UNLOCKED;
+    #define HISTORY_LOCK()   portENTER_CRITICAL(&_lock)
+    #define HISTORY_UNLOCK() portEXIT_CRITICAL(&_lock)
+#else
+    #define HISTORY_LOCK()
+    #define HISTORY_UNLOCK()
+#endif
+
+    static uint16_t encode(float value, float scale) {
+        long steps = lroundf(value / scale);
+        return (uint16_t)constrain(steps, 0L, (long)HISTORY_EMPTY - 1);
+    }
+
+    static void clearAccumulator(Accumulator& acc) {
+        acc.sum = 0.0f;
+        acc.count = 0;
+        acc.min = acc.max = acc.last = 0.0f;
+    }
+
+    static void clearSlot(Tier& tier, uint32_t bucket) {
+        Bucket* slot = &tier.slots[(bucket % tier.capacity) * HISTORY_METRICS];
+        for (uint8_t m = 0; m < HISTORY_METRICS; m++) {
+            slot[m].min = slot[m].max = slot[m].last = 0;
+            slot[m].mean = HISTORY_EMPTY;
+        }
+    }
+
+    // Stores the open bucket and starts `bucket`; skipped buckets stay empty
+    static void advance(Tier& tier, uint32_t bucket) {
+        Bucket* slot = &tier.slots[(tier.open % tier.capacity) * HISTORY_METRICS];
+        for (uint8_t m = 0; m < HISTORY_METRICS; m++) {
+            Accumulator& acc = tier.pending[m];
+            float scale = METRIC_SCALES[m];
+            if (acc.count == 0) {
+                slot[m].min = slot[m].max = slot[m].last = 0;
+                slot[m].mean = HISTORY_EMPTY;
+            } else {
+                slot[m].min = encode(acc.min, scale);
+                slot[m].max = encode(acc.max, scale);
+                slot[m].mean = encode(acc.sum / acc.count, scale);
+                slot[m].last = encode(acc.last, scale);
+            }
+            clearAccumulator(acc);
+        }
+
+        uint32_t gap = bucket - tier.open - 1;
+        if (gap > tier.capacity) gap = tier.capacity;
+        for (uint32_t b = bucket - gap; b != bucket; b++) clearSlot(tier, b);
+        tier.open = bucket;
+    }
+
+    void begin() {
+        for (uint8_t t = 0; t < HISTORY_TIERS; t++) {
+            Tier& tier = _tiers[t];
+            for (uint16_t b = 0; b < tier.capacity; b++) clearSlot(tier, b);
+            for (uint8_t m = 0; m < HISTORY_METRICS; m++) clearAccumulator(tier.pending[m]);
+            tier.first = tier.open = 0;
+        }
+        _started = false;
+        _clockMs = 0;
+        Serial.printf("📚 Metric history: %u s / %u min / %u h of %d metrics (%u bytes).\n",
+            HISTORY_SECONDS_BUCKETS, HISTORY_MINUTES_BUCKETS, HISTORY_HOURS_BUCKETS, HISTORY_METRICS,
+            (unsigned)(sizeof(_seconds) + sizeof(_minutes) + sizeof(_hours)));
+    }
+
+    void record(uint32_t timestampMs, float power, float current, float level) {
+        if (!_started) {
+            _clockMs = timestampMs;
+        } else {
+            _clockMs += (uint32_t)(timestampMs - _lastTimestampMs);
+        }
+        _lastTimestampMs = timestampMs;
+        uint32_t seconds = _clockMs / 1000;
+        const float values[HISTORY_METRICS] = { power, current, level };
+
+        for (uint8_t t = 0; t < HISTORY_TIERS; t++) {
+            Tier& tier = _tiers[t];
+            uint32_t bucket = seconds / tier.resolution;
+            HISTORY_LOCK();
+            if (!_started) {
+                tier.first = tier.open = bucket;
+            } else if (bucket != tier.open) {
+                advance(tier, bucket);
+            }
+
+            for (uint8_t m = 0; m < HISTORY_METRICS; m++) {
+                float value = values[m];
+                if (value < 0) continue;
+                Accumulator& acc = tier.pending[m];
+                if (acc.count == 0 || value < acc.min) acc.min = value;
+                if (acc.count == 0 || value > acc.max) acc.max = value;
+                acc.sum += value;
+                acc.last = value;
+                acc.count++;
+            }
+            HISTORY_UNLOCK();
+        }
+        _started = true;
+    }
+
+    // Copies one stored bucket consistently; false when it is empty
+    static bool readSlot(const Tier& tier, uint32_t bucket, HistoryMetric metric, HistoryPoint& point) {
+        HISTORY_LOCK();
+        Bucket copy = tier.slots[(bucket % tier.capacity) * HISTORY_METRICS + metric];
+        HISTORY_UNLOCK();
+        if (copy.mean == HISTORY_EMPTY) return false;
+
+        float scale = METRIC_SCALES[metric];
+        point.time = bucket * tier.resolution;
+        point.min = copy.min * scale;
+        point.max = copy.max * scale;
+        point.mean = copy.mean * scale;
+        point.last = copy.last * scale;
+        return true;
+    }
+
+    static bool readPending(const Tier& tier, HistoryMetric metric, HistoryPoint& point) {
+        HISTORY_LOCK();
+        Accumulator copy = tier.pending[metric];
+        uint32_t bucket = tier.open;
+        HISTORY_UNLOCK();
+        if (copy.count == 0) return false;
+
+        point.time = bucket * tier.resolution;
+        point.min = copy.min;
+        point.max = copy.max;
+        point.mean = copy.sum / copy.count;
+        point.last = copy.last;
+        return true;
+    }
+
+    size_t query(HistoryMetric metric, HistoryTier tierIndex, uint32_t fromSec, uint32_t toSec, HistoryPoint* out, size_t maxPoints) {
+        if (!_started || metric >= HISTORY_METRICS || tierIndex >= HISTORY_TIERS || maxPoints == 0) return 0;
+        const Tier& tier = _tiers[tierIndex];
+
+        // Closed buckets still in the ring: [open - capacity, open)
+        HISTORY_LOCK();
+        uint32_t open = tier.open;
+        uint32_t first = tier.first;
+        HISTORY_UNLOCK();
+        uint32_t oldest = open - first > tier.capacity ? open - tier.capacity : first;
+        uint32_t from = max(fromSec / tier.resolution, oldest);
+        uint32_t to = toSec / tier.resolution;
+
+        size_t count = 0;
+        for (uint32_t b = from; b < open && b <= to && count < maxPoints; b++) {
+            if (readSlot(tier, b, metric, out[count])) count++;
+        }
+        if (count < maxPoints && from <= open && open <= to && readPending(tier, metric, out[count])) count++;
+        return count;
+    }
+
+    uint32_t now() {
+        return _clockMs / 1000;
+    }
+
+    uint32_t getResolution(HistoryTier tier) {
+        return tier < HISTORY_TIERS ? _tiers[tier].resolution : 0;
+    }
+
+    uint16_t getCapacity(HistoryTier tier) {
+        return tier < HISTORY_TIERS ? _tiers[tier].capacity : 0;
+    }
+
+    const char* getMetricName(HistoryMetric metric) {
+        return metric < HISTORY_METRICS ? METRIC_NAMES[metric] : "?";
+    }
+
+    bool parseMetric(const char* name, HistoryMetric& metric) {
+        for (uint8_t m = 0; m < HISTORY_METRICS; m++) {
+            if (strcmp(name, METRIC_NAMES[m]) == 0) {
+                metric = (HistoryMetric)m;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool parseResolution(uint32_t seconds, HistoryTier& tier) {
+        for (uint8_t t = 0; t < HISTORY_TIERS; t++) {
+            if (_tiers[t].resolution == seconds) {
+                tier = (HistoryTier)t;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool handleCommand(const char* line) {
+        if (strcmp(line, "history") != 0) return false;
+
+        Serial.printf("📚 Metric history at %lu s:\n", (unsigned long)now());
+        for (uint8_t t = 0; t < HISTORY_TIERS; t++) {
+            const Tier& tier = _tiers[t];
+            uint32_t filled = _started ? min(tier.open - tier.first, (uint32_t)tier.capacity) : 0;
+            Serial.printf("   %4lu s x %4u: %4lu closed", (unsigned long)tier.resolution, tier.capacity, (unsigned long)filled);
+            for (uint8_t m = 0; m < HISTORY_METRICS; m++) {
+                HistoryPoint point;
+                if (filled > 0 && readSlot(tier, tier.open - 1, (HistoryMetric)m, point)) {
+                    Serial.printf(" | %s %.2f..%.2f avg %.2f", METRIC_NAMES[m], point.min, point.max, point.mean);
+                }
+            }
+            Serial.println();
+        }
+        return true;
+    }
+}
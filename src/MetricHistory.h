@@ -0,0 +1,68 @@
+// MetricHistory.h
+
+#ifndef METRIC_HISTORY_H
+#define METRIC_HISTORY_H
+
+#include <Arduino.h>
+
+#define HISTORY_SECONDS_BUCKETS 600  // 1 s for the last 10 minutes
+#define HISTORY_MINUTES_BUCKETS 1440 // 1 min for the last day
+#define HISTORY_HOURS_BUCKETS   720  // 1 h for the last 30 days
+
+enum HistoryMetric {
+    HISTORY_POWER,    // W
+    HISTORY_CURRENT,  // A, main CT
+    HISTORY_LEVEL,    // % of the tank
+    HISTORY_METRICS
+};
+
+enum HistoryTier {
+    HISTORY_SECONDS,
+    HISTORY_MINUTES,
+    HISTORY_HOURS,
+    HISTORY_TIERS
+};
+
+// One bucket as returned by query()
+struct HistoryPoint {
+    uint32_t time;   // Bucket start, seconds since boot
+    float min;
+    float max;
+    float mean;
+    float last;
+};
+
+// Fixed-memory rollups of the measurement frames: min/max/mean/last per
+// metric at three resolutions, each in a preallocated ring. Buckets are
+// stored as 16-bit fixed point (8 bytes per metric), ~66 KB in total.
+// Every tier is fed from the frames directly, so the coarse ones are as
+// exact as the fine ones.
+namespace MetricHistory {
+    // Clears every tier
+    void begin();
+
+    // Adds one frame's values; negative values (no reading) are skipped
+    void record(uint32_t timestampMs, float power, float current, float level);
+
+    // Buckets of one metric whose start lies in [fromSec, toSec] (seconds
+    // since boot), oldest first, empty ones skipped. The open bucket comes
+    // last, partially filled. Returns the number copied.
+    size_t query(HistoryMetric metric, HistoryTier tier, uint32_t fromSec, uint32_t toSec, HistoryPoint* out, size_t maxPoints);
+
+    // Seconds since boot of the newest recorded frame (no millis() wrap)
+    uint32_t now();
+
+    uint32_t getResolution(HistoryTier tier);   // Seconds per bucket
+    uint16_t getCapacity(HistoryTier tier);
+
+    const char* getMetricName(HistoryMetric metric);
+    bool parseMetric(const char* name, HistoryMetric& metric);
+
+    // Tier with the given resolution in seconds; false when there is none
+    bool parseResolution(uint32_t seconds, HistoryTier& tier);
+
+    // "history" prints the fill level and the newest bucket of every tier
+    bool handleCommand(const char* line);
+}
+
+#endif // METRIC_HISTORY_H
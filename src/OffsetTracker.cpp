@@ -0,0 +1,62 @@
+// OffsetTracker.cpp
+
+#include "OffsetTracker.h"
+
+#define OFFSET_LEARN_CYCLES 250   // Idle cycles averaged on a fresh start (~5 s)
+#define OFFSET_IDLE_MARGIN  1.5f  // Idle while within this factor of the learned noise (+1 step)
+
+OffsetTracker::OffsetTracker(float nominalMidpoint, float maxDeviation, float idleThreshold)
+    : _nominal(nominalMidpoint), _maxDeviation(maxDeviation), _idleThreshold(idleThreshold),
+      _midpoint(nominalMidpoint), _noise(0.0f), _learned(false),
+      _idleRun(0), _learnCycles(0), _idleCycles(0) {
+}
+
+void OffsetTracker::restore(float midpoint, float noise) {
+    _midpoint = constrain(midpoint, _nominal - _maxDeviation, _nominal + _maxDeviation);
+    _noise = constrain(noise, 0.0f, _idleThreshold);
+    _learned = true;
+}
+
+// Once learned, a small steady load must not pass for noise: the cycle has
+// to stay close to the known floor, not just under the absolute limit
+float OffsetTracker::idleThreshold() const {
+    if (!_learned) return _idleThreshold;
+    return min(_idleThreshold, _noise * OFFSET_IDLE_MARGIN + 1.0f);
+}
+
+void OffsetTracker::addWindow(float mean, float stddev, uint16_t cycles) {
+    if (cycles == 0) return;
+    if (stddev > idleThreshold()) {
+        _idleRun = 0;
+        return;
+    }
+    _idleRun += cycles;
+    if (_idleRun < OFFSET_IDLE_CYCLES) return; // Could be a load switching
+
+    float weight;
+    float maxStep;
+    if (_learned) {
+        weight = min(1.0f, OFFSET_ADAPT_RATE * cycles);
+        maxStep = OFFSET_MAX_STEP * cycles;
+    } else {
+        // Plain average of the first idle period
+        _learnCycles += cycles;
+        weight = (float)cycles / _learnCycles;
+        maxStep = _maxDeviation * 2;
+        if (_learnCycles >= OFFSET_LEARN_CYCLES) _learned = true;
+    }
+
+    float step = constrain((mean - _midpoint) * weight, -maxStep, maxStep);
+    _midpoint = constrain(_midpoint + step, _nominal - _maxDeviation, _nominal + _maxDeviation);
+
+    // Noise is averaged as variance, so correct() stays a quadrature subtraction
+    float variance = _noise * _noise;
+    variance += (stddev * stddev - variance) * weight;
+    _noise = constrain(sqrtf(variance), 0.0f, _idleThreshold);
+    _idleCycles += cycles;
+}
+
+float OffsetTracker::correct(float rms) const {
+    float squared = rms * rms - _noise * _noise;
+    return squared > 0 ? sqrtf(squared) : 0.0f;
+}
@@ -0,0 +1,53 @@
+// OffsetTracker.h
+
+#ifndef OFFSET_TRACKER_H
+#define OFFSET_TRACKER_H
+
+#include <Arduino.h>
+
+#define OFFSET_IDLE_CYCLES  100     // Idle mains cycles (~2 s) before adapting
+#define OFFSET_ADAPT_RATE   0.001f  // Weight per idle cycle once learned (~20 s at 50 Hz)
+#define OFFSET_MAX_STEP     0.05f   // ADC steps the midpoint may move per cycle
+
+// Auto-zero for a current sensor. Fed with the mean and DC-free standard
+// deviation of whole mains cycles, it recognises idle periods (no AC load:
+// only the noise floor is left) and only then moves its midpoint and noise
+// estimates, slowly and within bounds. Loads never shift the zero, and a
+// load running at boot no longer ends up in the calibration.
+class OffsetTracker {
+public:
+    // nominalMidpoint +/- maxDeviation bounds the learned midpoint; a cycle
+    // counts as idle while its deviation is below idleThreshold (ADC steps)
+    OffsetTracker(float nominalMidpoint = 2048.0f, float maxDeviation = 500.0f, float idleThreshold = 8.0f);
+
+    // Values learned on a previous boot; adaptation continues from them at the slow rate
+    void restore(float midpoint, float noise);
+
+    // Statistics of `cycles` whole mains cycles, in ADC steps
+    void addWindow(float mean, float stddev, uint16_t cycles = 1);
+
+    float getMidpoint() const { return _midpoint; }
+    float getNoise() const { return _noise; }       // RMS of the idle signal
+
+    // Removes the noise floor in quadrature from an RMS value (steps)
+    float correct(float rms) const;
+
+    bool isIdle() const { return _idleRun > 0; }    // Last window looked idle (adapts the zero; not a reporting cutoff)
+    bool isLearned() const { return _learned; }      // Restored or seen a full idle period
+    uint32_t getIdleCycles() const { return _idleCycles; }
+
+private:
+    float idleThreshold() const;
+
+    float _nominal;
+    float _maxDeviation;
+    float _idleThreshold;
+    float _midpoint;
+    float _noise;
+    bool _learned;
+    uint32_t _idleRun;        // Consecutive idle cycles
+    uint32_t _learnCycles;    // Idle cycles averaged before the slow rate takes over
+    uint32_t _idleCycles;     // Total idle cycles adapted on
+};
+
+#endif // OFFSET_TRACKER_H
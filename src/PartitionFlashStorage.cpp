@@ -0,0 +1,42 @@
+// PartitionFlashStorage.cpp
+
+#include "PartitionFlashStorage.h"
+
+#if defined(ESP32)
+#include <Arduino.h>
+
+PartitionFlashStorage::PartitionFlashStorage(const char* label)
+    : _label(label), _partition(NULL) {}
+
+bool PartitionFlashStorage::begin() {
+    _partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, _label);
+    if (_partition == NULL) {
+        Serial.printf("⚠️ Flash partition '%s' not found.\n", _label);
+        return false;
+    }
+    return true;
+}
+
+uint32_t PartitionFlashStorage::sectorSize() const {
+    return SPI_FLASH_SEC_SIZE;
+}
+
+uint32_t PartitionFlashStorage::sectorCount() const {
+    return _partition ? _partition->size / SPI_FLASH_SEC_SIZE : 0;
+}
+
+bool PartitionFlashStorage::read(uint32_t offset, void* data, size_t length) {
+    if (_partition == NULL) return false;
+    return esp_partition_read(_partition, offset, data, length) == ESP_OK;
+}
+
+bool PartitionFlashStorage::write(uint32_t offset, const void* data, size_t length) {
+    if (_partition == NULL) return false;
+    return esp_partition_write(_partition, offset, data, length) == ESP_OK;
+}
+
+bool PartitionFlashStorage::eraseSector(uint32_t sector) {
+    if (_partition == NULL) return false;
+    return esp_partition_erase_range(_partition, sector * SPI_FLASH_SEC_SIZE, SPI_FLASH_SEC_SIZE) == ESP_OK;
+}
+#endif
@@ -0,0 +1,30 @@
+// PartitionFlashStorage.h
+
+#ifndef PARTITION_FLASH_STORAGE_H
+#define PARTITION_FLASH_STORAGE_H
+
+#include "FlashStorage.h"
+
+#if defined(ESP32)
+#include <esp_partition.h>
+
+// FlashStorage on a data partition from partitions.csv, found by label
+class PartitionFlashStorage : public FlashStorage {
+public:
+    explicit PartitionFlashStorage(const char* label);
+
+    bool begin() override;
+    uint32_t sectorSize() const override;
+    uint32_t sectorCount() const override;
+
+    bool read(uint32_t offset, void* data, size_t length) override;
+    bool write(uint32_t offset, const void* data, size_t length) override;
+    bool eraseSector(uint32_t sector) override;
+
+private:
+    const char* _label;
+    const esp_partition_t* _partition;
+};
+#endif
+
+#endif // PARTITION_FLASH_STORAGE_H
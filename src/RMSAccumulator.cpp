@@ -0,0 +1,155 @@
+// RMSAccumulator.cpp
+
+#include "RMSAccumulator.h"
+
+#define RMS_MIN_FREQUENCY  40 // Longest accepted mains cycle
+#define RMS_MAX_FREQUENCY  70 // Shorter "cycles" are noise crossings
+#define RMS_HYSTERESIS     8  // ADC steps around the offset
+
+RMSAccumulator::RMSAccumulator() {
+    begin(10000);
+}
+
+void RMSAccumulator::begin(uint32_t sampleRateHz, uint16_t initialOffset) {
+    _minCycleSamples = sampleRateHz / RMS_MAX_FREQUENCY;
+    _maxCycleSamples = sampleRateHz / RMS_MIN_FREQUENCY;
+    _hysteresis = RMS_HYSTERESIS;
+    _offsetQ8 = (int32_t)initialOffset << 8;
+    _fixedLength = 0;
+    _lengthCarry = 0;
+    _targetSamples = 0;
+    reset();
+}
+
+void RMSAccumulator::reset() {
+    memset(_boundaries, 0, sizeof(_boundaries));
+    memset(&_total, 0, sizeof(_total));
+    _cycles = 0;
+    _cycleSamples = 0;
+    _positive = false;
+}
+
+void RMSAccumulator::setCycleLength(float cycleSamples) {
+    if (cycleSamples <= 0) {
+        _fixedLength = 0;
+        _targetSamples = 0;
+        return;
+    }
+    if (cycleSamples < _minCycleSamples) cycleSamples = _minCycleSamples;
+    if (cycleSamples > _maxCycleSamples) cycleSamples = _maxCycleSamples;
+
+    // A new length applies from the next cycle on; the open one keeps its target
+    bool wasFixed = _fixedLength > 0;
+    _fixedLength = cycleSamples;
+    if (!wasFixed) {
+        _lengthCarry = 0;
+        _targetSamples = (uint32_t)cycleSamples;
+    }
+}
+
+void RMSAccumulator::push(const uint16_t* samples, size_t count) {
+    // Work on locals so the hot loop stays in registers
+    uint64_t sum = _total.sum;
+    uint64_t sumSquares = _total.sumSquares;
+    uint32_t total = _total.count;
+    int32_t upper = (_offsetQ8 >> 8) + _hysteresis;
+    int32_t lower = (_offsetQ8 >> 8) - _hysteresis;
+
+    for (size_t i = 0; i < count; i++) {
+        uint32_t value = samples[i];
+        sum += value;
+        sumSquares += value * value;
+        total++;
+        _cycleSamples++;
+
+        if (_targetSamples > 0) {
+            if (_cycleSamples < _targetSamples) continue;
+        } else {
+            bool closed = false;
+            if (_positive) {
+                if ((int32_t)value < lower) _positive = false;
+            } else if ((int32_t)value > upper) {
+                _positive = true;
+                closed = _cycleSamples >= _minCycleSamples;
+            }
+            if (!closed && _cycleSamples < _maxCycleSamples) continue;
+        }
+
+        _total.sum = sum;
+        _total.sumSquares = sumSquares;
+        _total.count = total;
+        closeCycle();
+        upper = (_offsetQ8 >> 8) + _hysteresis;
+        lower = (_offsetQ8 >> 8) - _hysteresis;
+    }
+
+    _total.sum = sum;
+    _total.sumSquares = sumSquares;
+    _total.count = total;
+}
+
+void RMSAccumulator::closeCycle() {
+    _cycles++;
+    _boundaries[_cycles % (RMS_MAX_CYCLES + 1)] = _total;
+    _cycleSamples = 0;
+
+    if (_fixedLength > 0) {
+        _lengthCarry += _fixedLength;
+        _targetSamples = (uint32_t)_lengthCarry;
+        _lengthCarry -= _targetSamples;
+    }
+
+    // Follow the DC offset slowly: 1/8 of the way to the last cycle's mean
+    int32_t cycleMeanQ8 = (int32_t)(mean(1) * 256.0f);
+    _offsetQ8 += (cycleMeanQ8 - _offsetQ8) / 8;
+}
+
+bool RMSAccumulator::window(uint16_t cycles, Boundary& delta) const {
+    if (cycles == 0) cycles = 1;
+    uint16_t available = getCycleCount();
+    if (available == 0) return false;
+    if (cycles > available) cycles = available;
+
+    const Boundary& last = _boundaries[_cycles % (RMS_MAX_CYCLES + 1)];
+    const Boundary& first = _boundaries[(_cycles - cycles) % (RMS_MAX_CYCLES + 1)];
+    delta.sum = last.sum - first.sum;
+    delta.sumSquares = last.sumSquares - first.sumSquares;
+    delta.count = last.count - first.count;
+    return delta.count > 0;
+}
+
+float RMSAccumulator::rms(uint16_t cycles) const {
+    Boundary delta;
+    if (!window(cycles, delta)) return 0.0f;
+
+    // n * sum(x^2) - sum(x)^2 = n^2 * variance, exact in integers
+    uint64_t n = delta.count;
+    uint64_t scaled = n * delta.sumSquares;
+    uint64_t dc = delta.sum * delta.sum;
+    if (scaled <= dc) return 0.0f;
+    return sqrt((double)(scaled - dc)) / n;
+}
+
+float RMSAccumulator::mean(uint16_t cycles) const {
+    Boundary delta;
+    if (!window(cycles, delta)) return _offsetQ8 / 256.0f;
+    return (float)delta.sum / delta.count;
+}
+
+uint16_t RMSAccumulator::getCycleCount() const {
+    return _cycles < RMS_MAX_CYCLES ? _cycles : RMS_MAX_CYCLES;
+}
+
+uint32_t RMSAccumulator::getTotalCycles() const {
+    return _cycles;
+}
+
+uint32_t RMSAccumulator::getLastCycleSamples() const {
+    Boundary delta;
+    if (!window(1, delta)) return 0;
+    return delta.count;
+}
+
+float RMSAccumulator::getOffset() const {
+    return _offsetQ8 / 256.0f;
+}
@@ -0,0 +1,75 @@
+// RMSAccumulator.h
+
+#ifndef RMS_ACCUMULATOR_H
+#define RMS_ACCUMULATOR_H
+
+#include <Arduino.h>
+
+#define RMS_MAX_CYCLES 32 // Closed cycles kept for rms(cycles)
+
+// Streaming true-RMS engine. Samples can be pushed in chunks of any size;
+// windows close on rising zero crossings so every result covers whole mains
+// cycles. The DC offset is removed per window (variance), so no fixed
+// midpoint is needed.
+class RMSAccumulator {
+public:
+    RMSAccumulator();
+
+    // Sets the cycle length limits from the sample rate. Without a zero
+    // crossing (no load) a window is closed after the longest allowed cycle.
+    void begin(uint32_t sampleRateHz, uint16_t initialOffset = 2048);
+
+    // Clears all history
+    void reset();
+
+    // Closes windows every cycleSamples samples (fractional, carried over)
+    // instead of on zero crossings, e.g. from a FrequencyTracker. 0 goes
+    // back to zero-crossing mode.
+    void setCycleLength(float cycleSamples);
+
+    // Adds raw ADC samples
+    void push(const uint16_t* samples, size_t count);
+
+    // RMS in ADC steps over the last closed cycles, O(1)
+    float rms(uint16_t cycles = 1) const;
+
+    // Mean (DC offset) in ADC steps over the last closed cycles, O(1)
+    float mean(uint16_t cycles = 1) const;
+
+    // Number of closed cycles available to rms()/mean()
+    uint16_t getCycleCount() const;
+
+    // Total number of cycles closed since begin()
+    uint32_t getTotalCycles() const;
+
+    // Length of the last closed cycle in samples
+    uint32_t getLastCycleSamples() const;
+
+    // Current zero-crossing reference in ADC steps
+    float getOffset() const;
+
+private:
+    struct Boundary {
+        uint64_t sum;        // Cumulative sum of samples at this boundary
+        uint64_t sumSquares; // Cumulative sum of squared samples
+        uint32_t count;      // Cumulative sample count (wraps, only differences are used)
+    };
+
+    void closeCycle();
+    bool window(uint16_t cycles, Boundary& delta) const;
+
+    Boundary _boundaries[RMS_MAX_CYCLES + 1];
+    Boundary _total;
+    uint32_t _cycles;
+    uint32_t _cycleSamples;   // Samples in the open cycle
+    uint32_t _minCycleSamples;
+    uint32_t _maxCycleSamples;
+    int32_t _offsetQ8;        // Zero-crossing reference, 8 fractional bits
+    uint16_t _hysteresis;
+    bool _positive;
+    float _fixedLength;       // Samples per cycle, 0 = zero-crossing mode
+    float _lengthCarry;       // Fraction of a sample carried between cycles
+    uint32_t _targetSamples;  // Length of the open cycle in fixed mode
+};
+
+#endif // RMS_ACCUMULATOR_H
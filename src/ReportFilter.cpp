@@ -0,0 +1,39 @@
+// ReportFilter.cpp
+
+#include "ReportFilter.h"
+
+ReportFilter::ReportFilter(float absDeadband, float pctDeadband, uint32_t minIntervalMs, uint32_t maxSilenceMs)
+    : _absDeadband(absDeadband), _pctDeadband(pctDeadband),
+      _minIntervalMs(minIntervalMs), _maxSilenceMs(maxSilenceMs),
+      _lastValue(0.0f), _lastReportMs(0), _hasReported(false),
+      _reports(0), _suppressed(0) {}
+
+bool ReportFilter::outsideDeadband(float value) const {
+    // The wider band wins: the absolute one keeps noise around zero out,
+    // the relative one keeps large values from reporting every few units
+    float change = fabsf(value - _lastValue);
+    float band = max(_absDeadband, fabsf(_lastValue) * _pctDeadband / 100.0f);
+    return change > band; // 0/0: any change
+}
+
+bool ReportFilter::shouldReport(float value, uint32_t nowMs) {
+    uint32_t silence = nowMs - _lastReportMs;
+    bool due = !_hasReported
+        || silence >= _maxSilenceMs
+        || (silence >= _minIntervalMs && outsideDeadband(value));
+
+    if (!due) {
+        _suppressed++;
+        return false;
+    }
+
+    _hasReported = true;
+    _lastValue = value;
+    _lastReportMs = nowMs;
+    _reports++;
+    return true;
+}
+
+void ReportFilter::reset() {
+    _hasReported = false;
+}
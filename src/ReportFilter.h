@@ -0,0 +1,41 @@
+// ReportFilter.h
+
+#ifndef REPORT_FILTER_H
+#define REPORT_FILTER_H
+
+#include <Arduino.h>
+
+// Report-by-exception for one metric. Every sample is evaluated; a report is
+// due when the value left the deadband around the last reported value (and
+// minIntervalMs passed), or when nothing was sent for maxSilenceMs.
+class ReportFilter {
+public:
+    // absDeadband in metric units, pctDeadband in percent of the last
+    // reported value; a change must exceed both. 0/0 reports any change.
+    ReportFilter(float absDeadband, float pctDeadband, uint32_t minIntervalMs, uint32_t maxSilenceMs);
+
+    // Returns true when value should be sent now and takes it as the new reference
+    bool shouldReport(float value, uint32_t nowMs);
+
+    // Forces the next evaluation to report (e.g. after a reconnect)
+    void reset();
+
+    float getLastReported() const { return _lastValue; }
+    uint32_t getReportCount() const { return _reports; }
+    uint32_t getSuppressedCount() const { return _suppressed; }
+
+private:
+    bool outsideDeadband(float value) const;
+
+    float _absDeadband;
+    float _pctDeadband;
+    uint32_t _minIntervalMs;
+    uint32_t _maxSilenceMs;
+    float _lastValue;
+    uint32_t _lastReportMs;
+    bool _hasReported;
+    uint32_t _reports;
+    uint32_t _suppressed;
+};
+
+#endif // REPORT_FILTER_H
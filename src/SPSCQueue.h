@@ -0,0 +1,46 @@
+// SPSCQueue.h
+
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <stddef.h>
+#include <atomic>
+
+// Lock-free queue for exactly one producer task and one consumer task.
+// Capacity must be a power of two; one slot is never used.
+template <typename T, size_t Capacity>
+class SPSCQueue {
+public:
+    SPSCQueue() : _head(0), _tail(0) {}
+
+    // Producer side: returns false (and drops the item) when the queue is full
+    bool push(const T& item) {
+        size_t head = _head.load(std::memory_order_relaxed);
+        size_t next = (head + 1) & (Capacity - 1);
+        if (next == _tail.load(std::memory_order_acquire)) return false;
+        _items[head] = item;
+        _head.store(next, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side: returns false when the queue is empty
+    bool pop(T& item) {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail == _head.load(std::memory_order_acquire)) return false;
+        item = _items[tail];
+        _tail.store((tail + 1) & (Capacity - 1), std::memory_order_release);
+        return true;
+    }
+
+    bool isEmpty() const {
+        return _tail.load(std::memory_order_acquire) == _head.load(std::memory_order_acquire);
+    }
+
+private:
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+    T _items[Capacity];
+    std::atomic<size_t> _head;
+    std::atomic<size_t> _tail;
+};
+
+#endif // SPSC_QUEUE_H
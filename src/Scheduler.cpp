@@ -0,0 +1,144 @@
+// Scheduler.cpp
+
+#include "Scheduler.h"
+
+Scheduler::Scheduler(const char* name) : _name(name), _jobCount(0), _idleUs(0) {}
+
+int8_t Scheduler::addJob(const char* name, JobFunction function, uint32_t periodMs, uint32_t deadlineMs, uint32_t budgetUs) {
+    if (_jobCount >= SCHEDULER_MAX_JOBS || function == NULL || periodMs == 0) return -1;
+
+    Job& job = _jobs[_jobCount];
+    job = Job();
+    job.name = name;
+    job.function = function;
+    job.periodUs = periodMs * 1000UL;
+    job.deadlineUs = (deadlineMs == 0 ? periodMs : deadlineMs) * 1000UL;
+    job.budgetUs = budgetUs;
+    job.releaseUs = micros();
+    job.enabled = true;
+    return _jobCount++;
+}
+
+void Scheduler::setEnabled(int8_t id, bool enabled) {
+    if (id < 0 || id >= _jobCount) return;
+    if (enabled && !_jobs[id].enabled) _jobs[id].releaseUs = micros();
+    _jobs[id].enabled = enabled;
+}
+
+void Scheduler::trigger(int8_t id) {
+    if (id < 0 || id >= _jobCount) return;
+    _jobs[id].releaseUs = micros();
+}
+
+// Earliest absolute deadline among the released jobs; table order breaks ties
+int8_t Scheduler::nextJob(uint32_t now) const {
+    int8_t best = -1;
+    int32_t bestSlack = 0;
+    for (uint8_t i = 0; i < _jobCount; i++) {
+        const Job& job = _jobs[i];
+        if (!job.enabled || (int32_t)(now - job.releaseUs) < 0) continue;
+        int32_t slack = (int32_t)(job.releaseUs + job.deadlineUs - now);
+        if (best < 0 || slack < bestSlack) {
+            best = i;
+            bestSlack = slack;
+        }
+    }
+    return best;
+}
+
+bool Scheduler::runOnce() {
+    uint32_t start = micros();
+    int8_t id = nextJob(start);
+    if (id < 0) return false;
+
+    Job& job = _jobs[id];
+    job.function();
+    uint32_t end = micros();
+    uint32_t elapsed = end - start;
+
+    job.runs++;
+    job.lastUs = elapsed;
+    job.runTime.record(elapsed);
+    if (job.budgetUs > 0 && elapsed > job.budgetUs) job.overruns++;
+    if ((int32_t)(end - (job.releaseUs + job.deadlineUs)) > 0) job.misses++;
+
+    // Keep the release grid; if a whole period was lost, restart a period
+    // from now so a job slower than its period cannot run back to back
+    job.releaseUs += job.periodUs;
+    if ((int32_t)(end - job.releaseUs) >= (int32_t)job.periodUs) {
+        job.skipped += (end - job.releaseUs) / job.periodUs;
+        job.releaseUs = end + job.periodUs;
+    }
+    return true;
+}
+
+uint32_t Scheduler::untilNextRelease() const {
+    uint32_t now = micros();
+    uint32_t wait = UINT32_MAX;
+    for (uint8_t i = 0; i < _jobCount; i++) {
+        if (!_jobs[i].enabled) continue;
+        int32_t delta = (int32_t)(_jobs[i].releaseUs - now);
+        if (delta <= 0) return 0;
+        if ((uint32_t)delta < wait) wait = delta;
+    }
+    return wait;
+}
+
+void Scheduler::run(uint32_t maxSleepMs) {
+    uint32_t passStart = micros();
+    uint8_t runs = 0;
+    while (runs < _jobCount && runOnce()) runs++;
+    if (runs > 0) _passTime.record(micros() - passStart);
+
+    // Block the task so the idle task can put the core to sleep. At least a
+    // tick even when jobs are still ready: on the metering task's priority
+    // anything less starves IDLE0 and trips the task watchdog.
+    uint32_t waitMs = (untilNextRelease() + 999) / 1000;
+    if (waitMs > maxSleepMs) waitMs = maxSleepMs;
+    if (waitMs == 0) waitMs = 1;
+    uint32_t start = micros();
+    delay(waitMs);
+    _idleUs += micros() - start;
+}
+
+uint32_t Scheduler::getOverrunCount() const {
+    uint32_t total = 0;
+    for (uint8_t i = 0; i < _jobCount; i++) {
+        total += _jobs[i].overruns + _jobs[i].misses;
+    }
+    return total;
+}
+
+void Scheduler::printStats() const {
+    Serial.printf("🗓️ Scheduler '%s' (idle %lu ms)\n", _name, (unsigned long)getIdleMs());
+    Serial.printf("   %-10s %7s %9s %8s %8s %8s %8s %7s %7s\n",
+        "job", "period", "budget_us", "runs", "p50_us", "p99_us", "max_us", "overrun", "missed");
+    for (uint8_t i = 0; i < _jobCount; i++) {
+        const Job& job = _jobs[i];
+        Serial.printf("   %-10s %5lums %9lu %8lu %8lu %8lu %8lu %7lu %7lu\n",
+            job.name,
+            (unsigned long)(job.periodUs / 1000),
+            (unsigned long)job.budgetUs,
+            (unsigned long)job.runs,
+            (unsigned long)job.runTime.percentile(50),
+            (unsigned long)job.runTime.percentile(99),
+            (unsigned long)job.runTime.getMax(),
+            (unsigned long)job.overruns,
+            (unsigned long)job.misses);
+    }
+    Serial.printf("   %-10s %7s %9s %8lu %8lu %8lu %8lu\n", "(pass)", "", "",
+        (unsigned long)_passTime.getCount(),
+        (unsigned long)_passTime.percentile(50),
+        (unsigned long)_passTime.percentile(99),
+        (unsigned long)_passTime.getMax());
+}
+
+void Scheduler::resetStats() {
+    for (uint8_t i = 0; i < _jobCount; i++) {
+        Job& job = _jobs[i];
+        job.runs = job.overruns = job.misses = job.skipped = job.lastUs = 0;
+        job.runTime.reset();
+    }
+    _passTime.reset();
+    _idleUs = 0;
+}
@@ -0,0 +1,82 @@
+// Scheduler.h
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <Arduino.h>
+#include "LatencyHistogram.h"
+
+#define SCHEDULER_MAX_JOBS 12
+
+typedef void (*JobFunction)();
+
+// Cooperative earliest-deadline-first scheduler for one task (loop() or the
+// metering task). Every job declares a period, a relative deadline and a
+// worst-case budget; jobs run to completion, so a job that breaks its budget
+// shows up in the overrun counters instead of silently stretching the loop.
+class Scheduler {
+public:
+    struct Job {
+        const char* name;
+        JobFunction function;
+        uint32_t periodUs;
+        uint32_t deadlineUs;  // Relative to the release time
+        uint32_t budgetUs;    // Expected worst-case run time
+        uint32_t releaseUs;   // Next release time
+        bool enabled;
+        uint32_t runs;
+        uint32_t overruns;    // Ran longer than budgetUs
+        uint32_t misses;      // Finished after its deadline
+        uint32_t skipped;     // Releases dropped because the job fell a period behind
+        uint32_t lastUs;
+        LatencyHistogram runTime; // Per-run duration in us
+    };
+
+    explicit Scheduler(const char* name);
+
+    // Returns the job id, or -1 when the table is full. A deadline of 0 means
+    // the end of the period; a budget of 0 disables overrun counting.
+    int8_t addJob(const char* name, JobFunction function, uint32_t periodMs, uint32_t deadlineMs, uint32_t budgetUs);
+
+    void setEnabled(int8_t id, bool enabled);
+
+    // Releases a job right away (e.g. after a manual pump command)
+    void trigger(int8_t id);
+
+    // Runs the released job with the earliest deadline; false when none was ready
+    bool runOnce();
+
+    // Runs ready jobs, at most as many runs in total as there are jobs (an
+    // overdue job may take several of them), then sleeps until the next
+    // release: at least 1 ms, at most maxSleepMs
+    void run(uint32_t maxSleepMs = 10);
+
+    // Microseconds until the next release (0 when a job is ready)
+    uint32_t untilNextRelease() const;
+
+    uint8_t getJobCount() const { return _jobCount; }
+    const Job& getJob(uint8_t id) const { return _jobs[id]; }
+    uint32_t getOverrunCount() const;
+    uint32_t getIdleMs() const { return _idleUs / 1000; }
+    const char* getName() const { return _name; }
+
+    // Busy time of each run() pass, i.e. one loop iteration without the sleep
+    const LatencyHistogram& getPassTime() const { return _passTime; }
+
+    // Prints the task table with p50/p99/max run times and overrun counters
+    void printStats() const;
+
+    // Clears histograms and counters (the job table stays)
+    void resetStats();
+
+private:
+    int8_t nextJob(uint32_t now) const;
+
+    const char* _name;
+    Job _jobs[SCHEDULER_MAX_JOBS];
+    uint8_t _jobCount;
+    uint64_t _idleUs;
+    LatencyHistogram _passTime;
+};
+
+#endif // SCHEDULER_H
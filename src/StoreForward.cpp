@@ -0,0 +1,223 @@
+// StoreForward.cpp
+
+#include "StoreForward.h"
+#include "Checksum.h"
+#include <time.h>
+
+#define STORE_RECORD_MAGIC 0x54454C4DUL // "TELM"
+#define STORE_SPILL_BATCH  32          // RAM records moved to flash at once
+
+namespace StoreForward {
+    // Flash slot; "consumed" starts erased and is cleared to 0 on delivery,
+    // which NOR flash allows without an erase
+    struct FlashRecord {
+        uint32_t magic;
+        uint32_t sequence;
+        StoredRecord record;
+        uint32_t crc;
+        uint32_t consumed;
+    };
+
+    static StoredRecord _ram[STORE_RAM_RECORDS];
+    static uint32_t _ramHead = 0; // Free-running counters
+    static uint32_t _ramTail = 0;
+
+    static FlashStorage* _storage = NULL;
+    static uint32_t _flashHead = 0;     // Offset of the next slot to write
+    static uint32_t _flashTail = 0;     // Offset of the oldest pending slot
+    static uint32_t _flashPending = 0;
+    static uint32_t _nextSequence = 1;
+
+    static uint32_t _minIntervalMs = 0;
+    static uint32_t _lastStoredMs = 0;
+    static bool _hasStored = false;
+    static uint32_t _dropped = 0;
+
+    // Offsets of the flash records returned by the last peek()
+    static uint32_t _peekOffsets[STORE_RAM_RECORDS];
+    static size_t _peekFlash = 0;
+    static size_t _peekRam = 0;
+
+    static uint32_t slotsPerSector() {
+        return _storage->sectorSize() / sizeof(FlashRecord);
+    }
+
+    static uint32_t nextSlot(uint32_t offset) {
+        uint32_t sectorSize = _storage->sectorSize();
+        offset += sizeof(FlashRecord);
+        if (offset % sectorSize >= slotsPerSector() * sizeof(FlashRecord)) {
+            offset += sectorSize - (offset % sectorSize);
+        }
+        return offset >= _storage->size() ? 0 : offset;
+    }
+
+    static bool readPending(uint32_t offset, FlashRecord& slot) {
+        if (!_storage->read(offset, &slot, sizeof(slot))) return false;
+        if (slot.magic != STORE_RECORD_MAGIC || slot.consumed != 0xFFFFFFFFUL) return false;
+        return slot.crc == Checksum::crc32(&slot, offsetof(FlashRecord, crc));
+    }
+
+    // Rebuilds head, tail and pending count after a reboot
+    static void recoverFlash() {
+        uint32_t newestSequence = 0, oldestSequence = 0;
+        bool anyRecord = false, anyPending = false;
+
+        for (uint32_t offset = 0; ; ) {
+            FlashRecord slot;
+            if (_storage->read(offset, &slot, sizeof(slot)) && slot.magic == STORE_RECORD_MAGIC &&
+                slot.crc == Checksum::crc32(&slot, offsetof(FlashRecord, crc))) {
+                if (!anyRecord || (int32_t)(slot.sequence - newestSequence) > 0) {
+                    newestSequence = slot.sequence;
+                    _flashHead = nextSlot(offset);
+                }
+                anyRecord = true;
+                if (slot.consumed == 0xFFFFFFFFUL) {
+                    _flashPending++;
+                    if (!anyPending || (int32_t)(slot.sequence - oldestSequence) < 0) {
+                        oldestSequence = slot.sequence;
+                        _flashTail = offset;
+                    }
+                    anyPending = true;
+                }
+            }
+            offset = nextSlot(offset);
+            if (offset == 0) break;
+        }
+
+        _nextSequence = newestSequence + 1;
+        if (!anyRecord) _flashHead = 0;
+        if (!anyPending) _flashTail = _flashHead;
+        // A fresh partition may hold anything; the first append erases its sector
+    }
+
+    static bool appendFlash(const StoredRecord& record) {
+        uint32_t sectorSize = _storage->sectorSize();
+
+        if (_flashHead % sectorSize == 0) {
+            // Reusing a sector: records still pending in it are lost
+            uint32_t sector = _flashHead / sectorSize;
+            if (_flashPending > 0) {
+                for (uint32_t slot = 0; slot < slotsPerSector(); slot++) {
+                    FlashRecord old;
+                    if (readPending(sector * sectorSize + slot * sizeof(FlashRecord), old)) {
+                        _flashPending--;
+                        _dropped++;
+                    }
+                }
+                if (_flashTail / sectorSize == sector) {
+                    _flashTail = nextSlot(sector * sectorSize + (slotsPerSector() - 1) * sizeof(FlashRecord));
+                }
+            }
+            if (!_storage->eraseSector(sector)) return false;
+        }
+
+        FlashRecord slot;
+        slot.magic = STORE_RECORD_MAGIC;
+        slot.sequence = _nextSequence++;
+        slot.record = record;
+        slot.crc = Checksum::crc32(&slot, offsetof(FlashRecord, crc));
+        slot.consumed = 0xFFFFFFFFUL;
+
+        uint32_t offset = _flashHead;
+        _flashHead = nextSlot(_flashHead);
+        if (!_storage->write(offset, &slot, sizeof(slot))) return false;
+
+        if (_flashPending == 0) _flashTail = offset;
+        _flashPending++;
+        return true;
+    }
+
+    // Moves the oldest RAM records to flash to make room in the hot ring
+    static void spill() {
+        for (uint8_t i = 0; i < STORE_SPILL_BATCH && _ramTail != _ramHead; i++) {
+            if (_storage == NULL || !appendFlash(_ram[_ramTail % STORE_RAM_RECORDS])) {
+                _dropped++;
+            }
+            _ramTail++;
+        }
+        _peekRam = 0;
+    }
+
+    void begin(FlashStorage* storage, uint32_t minIntervalMs) {
+        _minIntervalMs = minIntervalMs;
+        _storage = NULL;
+        if (storage != NULL && storage->begin() && storage->sectorCount() >= 2) {
+            _storage = storage;
+            recoverFlash();
+            if (_flashPending > 0) {
+                Serial.printf("📦 %lu buffered telemetry records waiting for upload.\n", (unsigned long)_flashPending);
+            }
+        }
+    }
+
+    bool store(const MeasurementFrame& frame) {
+        if (_hasStored && frame.timestampMs - _lastStoredMs < _minIntervalMs) return false;
+        _hasStored = true;
+        _lastStoredMs = frame.timestampMs;
+
+        if (_ramHead - _ramTail >= STORE_RAM_RECORDS) spill();
+
+        StoredRecord& record = _ram[_ramHead % STORE_RAM_RECORDS];
+        time_t now = time(NULL);
+        // Before NTP sync the clock starts near 1970; keep only the uptime then
+        record.unixTime = (now > 1600000000) ? now - (millis() - frame.timestampMs) / 1000 : 0;
+        record.uptimeMs = frame.timestampMs;
+        record.waterLevelPercent = frame.waterLevelPercent;
+        record.power = frame.power;
+        record.energyKWh = frame.energyKWh;
+        record.ctCurrent = frame.ctCurrent;
+        _ramHead++;
+        return true;
+    }
+
+    size_t peek(StoredRecord* out, size_t max) {
+        if (max > STORE_RAM_RECORDS) max = STORE_RAM_RECORDS;
+        size_t count = 0;
+        _peekFlash = 0;
+        _peekRam = 0;
+
+        // Flash holds the oldest records
+        uint32_t offset = _flashTail;
+        uint32_t remaining = _flashPending;
+        uint32_t scanned = 0;
+        uint32_t slots = _storage ? _storage->size() / sizeof(FlashRecord) : 0;
+        while (count < max && remaining > 0 && scanned++ < slots) {
+            FlashRecord slot;
+            if (readPending(offset, slot)) {
+                out[count++] = slot.record;
+                _peekOffsets[_peekFlash++] = offset;
+                remaining--;
+            }
+            offset = nextSlot(offset);
+        }
+
+        for (uint32_t i = _ramTail; count < max && i != _ramHead; i++) {
+            out[count++] = _ram[i % STORE_RAM_RECORDS];
+            _peekRam++;
+        }
+        return count;
+    }
+
+    void commit(size_t count) {
+        const uint32_t consumed = 0;
+        for (size_t i = 0; i < _peekFlash && count > 0; i++, count--) {
+            _storage->write(_peekOffsets[i] + offsetof(FlashRecord, consumed), &consumed, sizeof(consumed));
+            _flashPending--;
+            _flashTail = nextSlot(_peekOffsets[i]);
+        }
+        if (_flashPending == 0) _flashTail = _flashHead;
+
+        size_t fromRam = count < _peekRam ? count : _peekRam;
+        _ramTail += fromRam;
+        _peekFlash = 0;
+        _peekRam = 0;
+    }
+
+    uint32_t pending() {
+        return _flashPending + (_ramHead - _ramTail);
+    }
+
+    uint32_t getDropped() {
+        return _dropped;
+    }
+}
@@ -0,0 +1,43 @@
+// StoreForward.h
+
+#ifndef STORE_FORWARD_H
+#define STORE_FORWARD_H
+
+#include <Arduino.h>
+#include "FlashStorage.h"
+#include "MeteringTask.h"
+
+#define STORE_RAM_RECORDS 256 // Hot ring; spills to flash when full
+
+// Compact record kept while the uplink is down
+struct StoredRecord {
+    uint32_t unixTime;        // 0 when the clock was not synced yet
+    uint32_t uptimeMs;
+    float waterLevelPercent;
+    float power;
+    float energyKWh;
+    float ctCurrent;
+};
+
+namespace StoreForward {
+    // storage may be NULL (RAM only). Frames closer than minIntervalMs to
+    // the last stored one are skipped to stretch the buffer over long outages.
+    // Flash records are 40 bytes, 102 per 4 KB sector: at 5 s spacing the
+    // 256 KB "telemetry" partition covers 8.9-9.1 h (wrapping erases a
+    // whole sector of the oldest records), the RAM ring another ~21 min.
+    void begin(FlashStorage* storage, uint32_t minIntervalMs);
+
+    // Buffers a frame that could not be sent
+    bool store(const MeasurementFrame& frame);
+
+    // Copies up to max of the oldest records without removing them
+    size_t peek(StoredRecord* out, size_t max);
+
+    // Removes the records returned by the last peek() once they were delivered
+    void commit(size_t count);
+
+    uint32_t pending();
+    uint32_t getDropped();
+}
+
+#endif // STORE_FORWARD_H
@@ -0,0 +1,245 @@
+// TelemetryPipeline.cpp
+
+#include "TelemetryPipeline.h"
+#include "MQTTModule.h"
+#include "StoreForward.h"
+#include "CTManager.h"
+#include "TelemetryCodec.h"
+#include <stdarg.h>
+#include <time.h>
+
+#define TELEMETRY_RETRY_MS 1000
+
+namespace TelemetryPipeline {
+    static MeasurementFrame _samples[TELEMETRY_MAX_BATCH];
+    static uint16_t _sampleCount = 0;
+    static uint16_t _maxSamples = TELEMETRY_MAX_BATCH;
+    static uint32_t _cadenceMs = 5000;
+    static unsigned long _batchStartMs = 0;
+
+    static MeasurementFrame _inFlightFrames[TELEMETRY_MAX_BATCH]; // Kept until delivered
+    static char _topic[64];
+    static char _binaryTopic[72];
+    static TelemetryEncoding _encoding = TELEMETRY_JSON;
+    static char _backfillTopic[64];
+    static unsigned long _lastBackfillMs = 0;
+    static char _payload[TELEMETRY_PAYLOAD_SIZE];
+    static size_t _payloadLength = 0;
+    static uint16_t _payloadSamples = 0;
+    static uint32_t _batchSequence = 0;
+    static unsigned long _lastAttemptMs = 0;
+
+    static Stats _stats = { 0, 0, 0, 0, 0, 0, 0, 0 };
+
+    void begin(const char* deviceId, uint32_t cadenceMs, uint16_t maxSamples) {
+        _cadenceMs = cadenceMs;
+        _maxSamples = constrain(maxSamples, 1, TELEMETRY_MAX_BATCH);
+        snprintf(_topic, sizeof(_topic), "home_iot/%s/telemetry", deviceId);
+        snprintf(_binaryTopic, sizeof(_binaryTopic), "%s/bin", _topic);
+        snprintf(_backfillTopic, sizeof(_backfillTopic), "home_iot/%s/backfill", deviceId);
+
+        // PubSubClient needs room for the topic and MQTT header as well
+        MQTTModule::setBufferSize(TELEMETRY_PAYLOAD_SIZE + sizeof(_topic) + 16);
+    }
+
+    bool addSample(const MeasurementFrame& frame) {
+        if (!MQTTModule::isConnected()) {
+            // Offline: keep it for backfill instead of dropping it
+            if (StoreForward::store(frame)) _stats.samplesStored++;
+            return true;
+        }
+        if (_sampleCount >= _maxSamples) {
+            _stats.samplesDropped++;
+            return false;
+        }
+        if (_sampleCount == 0) _batchStartMs = millis();
+        _samples[_sampleCount++] = frame;
+        return true;
+    }
+
+    void setEncoding(TelemetryEncoding encoding) {
+        _encoding = encoding;
+    }
+
+    // Appends with snprintf; returns false once the buffer is full
+    static bool append(char* buffer, size_t size, size_t& length, const char* format, ...) {
+        va_list args;
+        va_start(args, format);
+        int written = vsnprintf(buffer + length, size - length, format, args);
+        va_end(args);
+        if (written < 0 || length + written >= size) return false;
+        length += written;
+        return true;
+    }
+
+    // {"seq":N,"t0":ms,"ts":unix,"cols":[...],"rows":[[dt,...],...]}
+    // lvl and thd are -1 when there is no reading (no sonar, idle load).
+    // Extra CT circuits follow as "ct:<name>" columns. Names are clipped like
+    // the binary columns, so the header always fits the payload.
+    static uint16_t encodeJson(unsigned long unixStart) {
+        const MeasurementFrame& first = _samples[0];
+        size_t length = 0;
+        append(_payload, sizeof(_payload), length,
+            "{\"seq\":%lu,\"t0\":%lu,\"ts\":%lu,\"cols\":[\"dt\",\"lvl\",\"p\",\"e\",\"ct\",\"thd\",\"v\",\"pf\",\"hz\"",
+            (unsigned long)++_batchSequence, (unsigned long)first.timestampMs, unixStart);
+        for (uint8_t c = 1; c < first.ctChannels; c++) {
+            append(_payload, sizeof(_payload), length, ",\"ct:%.20s\"", CTManager::getChannel(c)->getName());
+        }
+        append(_payload, sizeof(_payload), length, "],\"rows\":[");
+
+        uint16_t written = 0;
+        uint16_t rows = 0;
+        while (written < _sampleCount) {
+            const MeasurementFrame& f = _samples[written];
+            char row[160 + CT_MAX_CHANNELS * 16];
+            size_t rowLength = 0;
+            bool ok = append(row, sizeof(row), rowLength, "%s[%lu,%.1f,%.1f,%.4f,%.2f,%.1f,%.1f,%.2f,%.2f",
+                rows ? "," : "",
+                (unsigned long)(f.timestampMs - first.timestampMs),
+                f.waterLevelPercent, f.power, f.energyKWh, f.ctCurrent, f.currentTHD, f.voltage, f.powerFactor, f.frequency);
+            for (uint8_t c = 1; ok && c < first.ctChannels; c++) {
+                ok = append(row, sizeof(row), rowLength, ",%.2f", f.ctCurrents[c]);
+            }
+            ok = ok && append(row, sizeof(row), rowLength, "]");
+            if (ok && length + rowLength + 3 > sizeof(_payload)) break; // Keep room for "]}"
+            written++;
+            if (!ok) {
+                // Out-of-range values; a broken row would spoil the whole batch
+                _stats.samplesDropped++;
+                continue;
+            }
+            memcpy(_payload + length, row, rowLength);
+            length += rowLength;
+            rows++;
+        }
+        append(_payload, sizeof(_payload), length, "]}");
+        _payloadLength = length;
+        return written;
+    }
+
+    // Same columns and precision as the JSON batch, in the TelemetryCodec
+    // format (delta-of-delta timestamps, XOR-compressed values)
+    static uint16_t encodeBinary(unsigned long unixStart) {
+        static const char* BASE_COLUMNS[] = { "lvl", "p", "e", "ct", "thd", "v", "pf", "hz" };
+        static const uint8_t BASE_DECIMALS[] = { 1, 1, 4, 2, 1, 1, 2, 2 };
+        static const uint8_t BASE_COUNT = sizeof(BASE_DECIMALS);
+        static char ctNames[CT_MAX_CHANNELS][24];
+
+        const MeasurementFrame& first = _samples[0];
+        const char* names[BASE_COUNT + CT_MAX_CHANNELS];
+        uint8_t decimals[BASE_COUNT + CT_MAX_CHANNELS];
+        uint8_t columns = 0;
+        for (uint8_t c = 0; c < BASE_COUNT; c++, columns++) {
+            names[columns] = BASE_COLUMNS[c];
+            decimals[columns] = BASE_DECIMALS[c];
+        }
+        for (uint8_t c = 1; c < first.ctChannels; c++, columns++) {
+            snprintf(ctNames[c], sizeof(ctNames[c]), "ct:%s", CTManager::getChannel(c)->getName());
+            names[columns] = ctNames[c];
+            decimals[columns] = 2;
+        }
+
+        static TelemetryEncoder encoder;
+        encoder.begin((uint8_t*)_payload, sizeof(_payload), ++_batchSequence, first.timestampMs, unixStart,
+            names, decimals, columns);
+        uint16_t written = 0;
+        while (written < _sampleCount) {
+            const MeasurementFrame& f = _samples[written];
+            float values[BASE_COUNT + CT_MAX_CHANNELS] = {
+                f.waterLevelPercent, f.power, (float)f.energyKWh, f.ctCurrent,
+                f.currentTHD, f.voltage, f.powerFactor, f.frequency
+            };
+            for (uint8_t c = 1; c < first.ctChannels; c++) values[BASE_COUNT + c - 1] = f.ctCurrents[c];
+            if (!encoder.addRow(f.timestampMs, values)) break;
+            written++;
+        }
+        _payloadLength = encoder.finish();
+        return written;
+    }
+
+    // Serializes as many queued samples as fit, once, into the payload buffer
+    static void sealBatch() {
+        time_t now = time(NULL);
+        unsigned long unixStart = (now > 1600000000) ? now - (millis() - _samples[0].timestampMs) / 1000 : 0;
+        uint16_t written = _encoding == TELEMETRY_BINARY ? encodeBinary(unixStart) : encodeJson(unixStart);
+
+        _payloadSamples = written;
+        _stats.inFlight = 1;
+        memcpy(_inFlightFrames, _samples, written * sizeof(MeasurementFrame));
+
+        // Samples that did not fit start the next batch
+        memmove(_samples, _samples + written, (_sampleCount - written) * sizeof(MeasurementFrame));
+        _sampleCount -= written;
+        _batchStartMs = millis();
+    }
+
+    // Publishes one batch of stored records, oldest first:
+    // {"backfill":N,"cols":[...],"rows":[[unix,uptime,...],...]}
+    static void sendBackfill() {
+        static StoredRecord records[TELEMETRY_BACKFILL_BATCH];
+        size_t count = StoreForward::peek(records, TELEMETRY_BACKFILL_BATCH);
+        if (count == 0) return;
+
+        int length = snprintf(_payload, sizeof(_payload),
+            "{\"backfill\":%u,\"cols\":[\"ts\",\"up\",\"lvl\",\"p\",\"e\",\"ct\"],\"rows\":[", (unsigned)count);
+        for (size_t i = 0; i < count && length < (int)sizeof(_payload); i++) {
+            const StoredRecord& r = records[i];
+            length += snprintf(_payload + length, sizeof(_payload) - length, "%s[%lu,%lu,%.1f,%.1f,%.4f,%.2f]",
+                i ? "," : "", (unsigned long)r.unixTime, (unsigned long)r.uptimeMs,
+                r.waterLevelPercent, r.power, r.energyKWh, r.ctCurrent);
+        }
+        if (length < (int)sizeof(_payload)) {
+            length += snprintf(_payload + length, sizeof(_payload) - length, "]}");
+        }
+        if (length >= (int)sizeof(_payload)) return; // Cannot happen with the batch size above
+
+        if (MQTTModule::publish(_backfillTopic, (const uint8_t*)_payload, length)) {
+            StoreForward::commit(count);
+            _stats.backfillSent += count;
+            _stats.bytesSent += length;
+        }
+    }
+
+    void loop() {
+        unsigned long now = millis();
+
+        // Lost the connection with a batch in flight: keep its samples for later
+        if (_stats.inFlight && !MQTTModule::isConnected()) {
+            for (uint16_t i = 0; i < _payloadSamples; i++) {
+                if (StoreForward::store(_inFlightFrames[i])) _stats.samplesStored++;
+            }
+            _stats.inFlight = 0;
+        }
+
+        if (!_stats.inFlight && _sampleCount > 0 &&
+            (_sampleCount >= _maxSamples || now - _batchStartMs >= _cadenceMs)) {
+            sealBatch();
+            _lastAttemptMs = now - TELEMETRY_RETRY_MS;
+        }
+
+        if (_stats.inFlight && now - _lastAttemptMs >= TELEMETRY_RETRY_MS) {
+            _lastAttemptMs = now;
+            const char* topic = _encoding == TELEMETRY_BINARY ? _binaryTopic : _topic;
+            if (MQTTModule::publish(topic, (const uint8_t*)_payload, _payloadLength)) {
+                _stats.batchesSent++;
+                _stats.samplesSent += _payloadSamples;
+                _stats.bytesSent += _payloadLength;
+                _stats.inFlight = 0;
+            } else {
+                _stats.publishFailures++;
+            }
+            return;
+        }
+
+        // Live data goes first; backfill only uses the idle gaps
+        if (!_stats.inFlight && MQTTModule::isConnected() && StoreForward::pending() > 0 &&
+            now - _lastBackfillMs >= TELEMETRY_BACKFILL_INTERVAL) {
+            _lastBackfillMs = now;
+            sendBackfill();
+        }
+    }
+
+    const Stats& getStats() {
+        return _stats;
+    }
+}
@@ -0,0 +1,52 @@
+// TelemetryPipeline.h
+
+#ifndef TELEMETRY_PIPELINE_H
+#define TELEMETRY_PIPELINE_H
+
+#include <Arduino.h>
+#include "MeteringTask.h"
+
+#define TELEMETRY_MAX_BATCH    32   // Hard cap on samples per message
+#define TELEMETRY_PAYLOAD_SIZE 2048 // Preallocated serialization buffer
+#define TELEMETRY_BACKFILL_BATCH    24   // Stored records per backfill message
+#define TELEMETRY_BACKFILL_INTERVAL 2000 // ms between backfill messages
+
+enum TelemetryEncoding {
+    TELEMETRY_JSON,    // Text batches on .../telemetry
+    TELEMETRY_BINARY   // TelemetryCodec batches on .../telemetry/bin
+};
+
+namespace TelemetryPipeline {
+    struct Stats {
+        uint32_t batchesSent;
+        uint32_t publishFailures; // Attempts the client refused (retried later)
+        uint32_t samplesSent;
+        uint32_t samplesDropped;  // Batch full while the previous one was still in flight,
+                                  // or a JSON row too long for its buffer
+        uint32_t bytesSent;
+        uint8_t inFlight;         // Sealed batch waiting to be accepted by the client
+        uint32_t samplesStored;   // Handed to StoreForward while offline
+        uint32_t backfillSent;    // Stored records delivered after reconnecting
+    };
+
+    // Batches go to home_iot/<deviceId>/telemetry every cadenceMs or when
+    // maxSamples are collected, whichever comes first
+    void begin(const char* deviceId, uint32_t cadenceMs, uint16_t maxSamples);
+
+    // Live batch format; binary is ~10x smaller at sub-second cadences.
+    // Backfill stays JSON.
+    void setEncoding(TelemetryEncoding encoding);
+
+    // Queues one frame; returns false when it had to be dropped
+    bool addSample(const MeasurementFrame& frame);
+
+    // Seals and publishes batches; call from loop() after MQTTModule::loop().
+    // While offline frames go to StoreForward; after reconnecting stored
+    // records are backfilled oldest first on home_iot/<deviceId>/backfill,
+    // rate limited and only while no live batch is waiting.
+    void loop();
+
+    const Stats& getStats();
+}
+
+#endif // TELEMETRY_PIPELINE_H
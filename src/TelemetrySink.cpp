@@ -0,0 +1,35 @@
+// TelemetrySink.cpp
+
+#include "TelemetrySink.h"
+
+namespace TelemetryHub {
+    static TelemetrySink* _sinks[TELEMETRY_MAX_SINKS];
+    static uint8_t _sinkCount = 0;
+
+    bool addSink(TelemetrySink* sink) {
+        if (sink == NULL || _sinkCount >= TELEMETRY_MAX_SINKS) return false;
+        _sinks[_sinkCount++] = sink;
+        Serial.printf("📤 Telemetry sink added: %s\n", sink->getName());
+        return true;
+    }
+
+    void dispatch(const MeasurementFrame& frame) {
+        for (uint8_t i = 0; i < _sinkCount; i++) {
+            _sinks[i]->offer(frame);
+        }
+    }
+
+    void loop() {
+        for (uint8_t i = 0; i < _sinkCount; i++) {
+            _sinks[i]->loop();
+        }
+    }
+
+    uint8_t getSinkCount() {
+        return _sinkCount;
+    }
+
+    TelemetrySink* getSink(uint8_t index) {
+        return index < _sinkCount ? _sinks[index] : NULL;
+    }
+}
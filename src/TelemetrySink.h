@@ -0,0 +1,70 @@
+// TelemetrySink.h
+
+#ifndef TELEMETRY_SINK_H
+#define TELEMETRY_SINK_H
+
+#include <Arduino.h>
+#include "MeteringTask.h"
+
+#define TELEMETRY_MAX_SINKS 8
+
+// One consumer of measurement frames (Blynk, MQTT, serial, local HTTP, ...).
+// Sinks never read sensors; they only format the frame they are handed.
+class TelemetrySink {
+public:
+    // minIntervalMs limits how often publish() runs; 0 passes every frame
+    TelemetrySink(const char* name, uint32_t minIntervalMs)
+        : _name(name), _minIntervalMs(minIntervalMs), _lastPublishMs(0),
+          _published(0), _skipped(0), _enabled(true), _hasPublished(false) {}
+    virtual ~TelemetrySink() {}
+
+    // Applies the enable flag and rate limit, then calls publish()
+    void offer(const MeasurementFrame& frame) {
+        if (!_enabled) return;
+        if (_hasPublished && frame.timestampMs - _lastPublishMs < _minIntervalMs) {
+            _skipped++;
+            return;
+        }
+        _hasPublished = true;
+        _lastPublishMs = frame.timestampMs;
+        _published++;
+        publish(frame);
+    }
+
+    // Called every loop() pass for connection and buffer housekeeping
+    virtual void loop() {}
+
+    void setEnabled(bool enabled) { _enabled = enabled; }
+    bool isEnabled() const { return _enabled; }
+    const char* getName() const { return _name; }
+    uint32_t getPublishCount() const { return _published; }
+    uint32_t getSkippedCount() const { return _skipped; }
+
+protected:
+    virtual void publish(const MeasurementFrame& frame) = 0;
+
+private:
+    const char* _name;
+    uint32_t _minIntervalMs;
+    uint32_t _lastPublishMs;
+    uint32_t _published;
+    uint32_t _skipped;
+    bool _enabled;
+    bool _hasPublished;
+};
+
+// Fans every new frame out to the registered sinks
+namespace TelemetryHub {
+    bool addSink(TelemetrySink* sink);
+
+    // Hands the same frame to every sink; the frame must not change meanwhile
+    void dispatch(const MeasurementFrame& frame);
+
+    // Runs loop() on every sink
+    void loop();
+
+    uint8_t getSinkCount();
+    TelemetrySink* getSink(uint8_t index);
+}
+
+#endif // TELEMETRY_SINK_H
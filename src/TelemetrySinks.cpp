@@ -0,0 +1,69 @@
+// TelemetrySinks.cpp
+
+#include "TelemetrySinks.h"
+#include "MQTTModule.h"
+#include "TelemetryPipeline.h"
+#include "WebServerModule.h"
+#include "WaterPumpModule.h"
+#include "CTManager.h"
+#include "MetricHistory.h"
+
+void SerialSink::publish(const MeasurementFrame& frame) {
+    Serial.printf("💧 Water Level: ");
+    if (_water) {
+        Serial.printf("%.2f cm (%.1f%%)", frame.waterLevelCm, frame.waterLevelPercent);
+    } else {
+        Serial.printf("N/A");
+    }
+
+    Serial.printf(" | ⚡ Power: ");
+    if (_energy) {
+        Serial.printf("%.2f W | Total Units: %.4f kWh", frame.power, frame.energyKWh);
+        if (frame.currentTHD >= 0) {
+            Serial.printf(" | THD: %.1f%%", frame.currentTHD);
+        }
+        if (frame.voltage > 0) {
+            Serial.printf(" | %.1f V | PF %.2f | %.1f VA", frame.voltage, frame.powerFactor, frame.apparentPower);
+        }
+        if (frame.frequency > 0) {
+            Serial.printf(" | %.2f Hz", frame.frequency);
+        }
+    } else {
+        Serial.printf("N/A");
+    }
+
+    Serial.printf(" | CT: ");
+    if (_ct) {
+        Serial.printf("%.2f A", frame.ctCurrent);
+        for (uint8_t c = 1; c < frame.ctChannels; c++) {
+            Serial.printf(", %s %.2f A", CTManager::getChannel(c)->getName(), frame.ctCurrents[c]);
+        }
+    } else {
+        Serial.printf("N/A");
+    }
+    Serial.printf(" | #%lu @ %lu ms\n", (unsigned long)frame.sequence, (unsigned long)frame.timestampMs);
+}
+
+void MqttSink::publish(const MeasurementFrame& frame) {
+    TelemetryPipeline::addSample(frame);
+}
+
+void MqttSink::loop() {
+    MQTTModule::loop(); // Also notices a WiFi outage, so batches go to flash
+    TelemetryPipeline::loop();
+}
+
+void WebSocketSink::publish(const MeasurementFrame& frame) {
+    WebServerModule::publish(frame, WaterPumpModule::isRunning());
+}
+
+void WebSocketSink::loop() {
+    WebServerModule::loop();
+}
+
+void HistorySink::publish(const MeasurementFrame& frame) {
+    MetricHistory::record(frame.timestampMs,
+        _energy ? frame.power : -1.0f,
+        _ct ? frame.ctCurrent : -1.0f,
+        frame.waterLevelPercent);
+}
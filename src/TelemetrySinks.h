@@ -0,0 +1,54 @@
+// TelemetrySinks.h
+
+#ifndef TELEMETRY_SINKS_H
+#define TELEMETRY_SINKS_H
+
+#include <Arduino.h>
+#include "TelemetrySink.h"
+
+// Human readable status line on the serial monitor
+class SerialSink : public TelemetrySink {
+public:
+    explicit SerialSink(uint32_t intervalMs)
+        : TelemetrySink("serial", intervalMs), _water(false), _energy(false), _ct(false) {}
+
+    // Modules found at boot; the others print N/A
+    void setModules(bool water, bool energy, bool ct) { _water = water; _energy = energy; _ct = ct; }
+protected:
+    void publish(const MeasurementFrame& frame) override;
+private:
+    bool _water, _energy, _ct;
+};
+
+// Batched JSON over MQTT (TelemetryPipeline), store-and-forward while offline
+class MqttSink : public TelemetrySink {
+public:
+    explicit MqttSink(uint32_t intervalMs) : TelemetrySink("mqtt", intervalMs) {}
+    void loop() override;
+protected:
+    void publish(const MeasurementFrame& frame) override;
+};
+
+// Compact JSON pushed to the local dashboard over /ws
+class WebSocketSink : public TelemetrySink {
+public:
+    explicit WebSocketSink(uint32_t intervalMs) : TelemetrySink("websocket", intervalMs) {}
+    void loop() override;
+protected:
+    void publish(const MeasurementFrame& frame) override;
+};
+
+// Rolls every frame into MetricHistory (served as /api/history)
+class HistorySink : public TelemetrySink {
+public:
+    HistorySink() : TelemetrySink("history", 0), _energy(false), _ct(false) {}
+
+    // Modules found at boot; absent ones record nothing instead of zeros
+    void setModules(bool energy, bool ct) { _energy = energy; _ct = ct; }
+protected:
+    void publish(const MeasurementFrame& frame) override;
+private:
+    bool _energy, _ct;
+};
+
+#endif // TELEMETRY_SINKS_H
@@ -3,12 +3,40 @@
 
 #include <Arduino.h>
 
+#define SONAR_MEDIAN_SAMPLES   5   // Pings per reading, median-filtered
+#define SONAR_PING_INTERVAL_MS 50  // Lets the previous echo die out
+#define SONAR_STALE_MS         2000 // Cached reading expires this long after the next one was due
+#define SONAR_CONFIRM_MS       3000 // A sensor assumed present must echo by then
+
+// Adaptive sampling: one reading (a burst of SONAR_MEDIAN_SAMPLES pings)
+// per interval, fast while the pump runs or the tank drains quickly, slow
+// while nothing moves, and earlier when a pump threshold is coming up
+#define SONAR_ACTIVE_INTERVAL_MS 1000  // Pump running, draining fast or no rate yet
+#define SONAR_IDLE_INTERVAL_MS   30000 // Static level, pump off
+#define SONAR_RATE_READINGS      4     // Readings in the fill/drain rate fit
+#define SONAR_FAST_DRAIN_CM_S    0.05f // Draining faster than this (3 cm/min) counts as active
+#define SONAR_RATE_DEADBAND_CM_S 0.01f // Slower fits are echo noise, the level counts as static
+#define SONAR_LEAD_FACTOR        0.5f  // Next reading at this fraction of the predicted crossing time
+
 namespace WaterLevelMonitor {
-    void begin(int triggerPin, int echoPin);
-    bool isConnected(); // Function to check for sensor presence
-    float getLevel();
+    // Probes the sensor (up to 500 ms) and returns whether it answered. With
+    // assumeConnected (known from a previous boot) it skips the probe and
+    // drops the sensor if no echo comes within SONAR_CONFIRM_MS.
+    bool begin(int triggerPin, int echoPin, bool assumeConnected = false);
+    bool isConnected(); // Function to check for sensor presence (blocking probe)
+    bool isPresent();   // Result of begin(), cleared when an assumed sensor never echoed
+    bool isConfirmed(); // At least one echo since begin(), the probe's included
+    void update();      // Non-blocking: starts pings and collects echoes
+    float getLevel();   // Cached, median-filtered distance in cm
     void calibrate(float minDist, float maxDist); // Set full & empty tank distances
     float getLevelPercent();
+    uint32_t getLevelTimestamp(); // millis() of the newest reading in the cache
+
+    // Pump thresholds (% of the tank) whose crossing the sampling aims at
+    void setThresholds(float pumpOnPercent, float pumpOffPercent);
+    void setPumpRunning(bool running); // Safe to call from the other core
+    float getRate();        // Fitted level change in %/min, positive while filling
+    uint32_t getInterval(); // ms from this reading to the next one
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -2,6 +2,7 @@
 #include <NewPing.h>
 
 #define MAX_DISTANCE 400 // Maximum distance in cm
+#define ECHO_TIMEOUT_US (MAX_DISTANCE * US_ROUNDTRIP_CM + 2000) // ~25 ms
 
 namespace WaterLevelMonitor {
     // Correctly define static variables
@@ -13,19 +14,198 @@ namespace WaterLevelMonitor {
     static float _minDistance = 5.0;   // Full tank (closest distance)
     static float _maxDistance = 50.0;  // Empty tank (farthest distance)
 
-    void begin(int triggerPin, int echoPin) {
+    // Echo capture (written by the ISR)
+    static volatile unsigned long _echoStart = 0;
+    static volatile unsigned long _echoEnd = 0;
+    static volatile bool _echoDone = false;
+
+    // Ping state and cached result
+    static bool _pingInFlight = false;
+    static unsigned long _pingStartMicros = 0;
+    static unsigned long _lastPingMs = 0;
+    static float _samples[SONAR_MEDIAN_SAMPLES];
+    static uint8_t _sampleCount = 0;
+    static uint8_t _sampleIndex = 0;
+    static float _cachedDistance = -1.0;
+    static uint32_t _cachedTimestamp = 0;
+    static bool _confirmed = false;          // Got an echo since begin()
+    static bool _assumed = false;            // Present from the cache, not probed
+    static unsigned long _beginMs = 0;
+
+    // Adaptive sampling
+    static bool _burstActive = false;
+    static uint8_t _burstPings = 0;
+    static unsigned long _burstStartMs = 0;
+    static unsigned long _nextReadingMs = 0;
+    static volatile uint32_t _intervalMs = SONAR_ACTIVE_INTERVAL_MS;
+    static volatile bool _pumpRunning = false;
+    static bool _lastPumpRunning = false;
+    static float _pumpOnPercent = -1.0;
+    static float _pumpOffPercent = -1.0;
+
+    // Recent readings for the rate fit
+    static float _readingCm[SONAR_RATE_READINGS];
+    static uint32_t _readingMs[SONAR_RATE_READINGS];
+    static uint8_t _readingCount = 0;
+    static uint8_t _readingIndex = 0;
+    static volatile float _rate = 0.0; // cm/s, positive while the distance grows (draining)
+
+    static void IRAM_ATTR echoISR() {
+        if (digitalRead(_echoPin)) {
+            _echoStart = micros();
+        } else {
+            _echoEnd = micros();
+            _echoDone = true;
+        }
+    }
+
+    static void startPing() {
+        _echoDone = false;
+        digitalWrite(_triggerPin, LOW);
+        delayMicroseconds(2);
+        digitalWrite(_triggerPin, HIGH);
+        delayMicroseconds(10);
+        digitalWrite(_triggerPin, LOW);
+        _pingStartMicros = micros();
+        _lastPingMs = millis();
+        _pingInFlight = true;
+        _burstPings++;
+    }
+
+    // Median of the filter window; a single bad echo never reaches the cache
+    static float median() {
+        float sorted[SONAR_MEDIAN_SAMPLES];
+        memcpy(sorted, _samples, _sampleCount * sizeof(float));
+        for (uint8_t i = 1; i < _sampleCount; i++) {
+            float value = sorted[i];
+            int8_t j = i - 1;
+            while (j >= 0 && sorted[j] > value) {
+                sorted[j + 1] = sorted[j];
+                j--;
+            }
+            sorted[j + 1] = value;
+        }
+        return sorted[_sampleCount / 2];
+    }
+
+    static void addSample(float distance) {
+        _samples[_sampleIndex] = distance;
+        _sampleIndex = (_sampleIndex + 1) % SONAR_MEDIAN_SAMPLES;
+        if (_sampleCount < SONAR_MEDIAN_SAMPLES) _sampleCount++;
+        _confirmed = true;
+    }
+
+    // Least-squares slope over the recent readings, in cm/s
+    static float fitRate() {
+        if (_readingCount < 2) return 0.0;
+        uint32_t newest = _readingMs[(_readingIndex + SONAR_RATE_READINGS - 1) % SONAR_RATE_READINGS];
+        float sumT = 0, sumD = 0, sumTT = 0, sumTD = 0;
+        for (uint8_t i = 0; i < _readingCount; i++) {
+            float t = -(float)(newest - _readingMs[i]) / 1000.0; // Seconds before the newest
+            sumT += t;
+            sumD += _readingCm[i];
+            sumTT += t * t;
+            sumTD += t * _readingCm[i];
+        }
+        float denominator = _readingCount * sumTT - sumT * sumT;
+        if (denominator <= 0) return 0.0;
+        float slope = (_readingCount * sumTD - sumT * sumD) / denominator;
+        return fabsf(slope) < SONAR_RATE_DEADBAND_CM_S ? 0.0 : slope;
+    }
+
+    static void addReading(float distance, uint32_t timestamp) {
+        _readingCm[_readingIndex] = distance;
+        _readingMs[_readingIndex] = timestamp;
+        _readingIndex = (_readingIndex + 1) % SONAR_RATE_READINGS;
+        if (_readingCount < SONAR_RATE_READINGS) _readingCount++;
+        _rate = fitRate();
+    }
+
+    // ms until the level reaches the pump threshold it is heading for;
+    // negative when it is static or already past that threshold (a full
+    // tank above pump-off, an empty one below pump-on)
+    static float timeToThreshold() {
+        if (_pumpOnPercent < 0 || _rate == 0) return -1.0;
+        float span = _maxDistance - _minDistance;
+        float remaining;
+        if (_rate > 0) {
+            remaining = _maxDistance - _pumpOnPercent / 100.0 * span - _cachedDistance;
+        } else {
+            remaining = _cachedDistance - (_maxDistance - _pumpOffPercent / 100.0 * span);
+        }
+        if (remaining <= 0) return -1.0;
+        return remaining / fabsf(_rate) * 1000.0;
+    }
+
+    static uint32_t nextInterval() {
+        if (_readingCount < 2) return SONAR_ACTIVE_INTERVAL_MS; // No rate yet
+
+        float interval = SONAR_IDLE_INTERVAL_MS;
+        if (_pumpRunning || _rate > SONAR_FAST_DRAIN_CM_S) interval = SONAR_ACTIVE_INTERVAL_MS;
+
+        // Land the next reading before the predicted crossing, with room for a bad estimate
+        float crossing = timeToThreshold();
+        if (crossing >= 0) interval = min(interval, crossing * SONAR_LEAD_FACTOR);
+        return constrain((uint32_t)interval, (uint32_t)SONAR_ACTIVE_INTERVAL_MS, (uint32_t)SONAR_IDLE_INTERVAL_MS);
+    }
+
+    static void startReading() {
+        _burstActive = true;
+        _burstPings = 0;
+        _burstStartMs = millis();
+        _sampleCount = 0;
+        _sampleIndex = 0;
+        startPing();
+    }
+
+    static void finishReading() {
+        _burstActive = false;
+        if (_sampleCount == 0) {
+            // No echo at all: keep the cached value and try again soon
+            _nextReadingMs = _burstStartMs + SONAR_ACTIVE_INTERVAL_MS;
+            return;
+        }
+        _cachedDistance = median();
+        _cachedTimestamp = millis();
+        addReading(_cachedDistance, _cachedTimestamp);
+        _intervalMs = nextInterval();
+        _nextReadingMs = _burstStartMs + _intervalMs;
+    }
+
+    bool begin(int triggerPin, int echoPin, bool assumeConnected) {
         _triggerPin = triggerPin;
         _echoPin = echoPin;
         _sonar = NewPing(triggerPin, echoPin, MAX_DISTANCE);
+        _confirmed = false;
+        _assumed = false;
+        _beginMs = millis();
+        _nextReadingMs = _beginMs;
         
         // Check for sensor connection immediately after initializing the object
-        if (isConnected()) {
+        if (assumeConnected && _triggerPin > 0 && _echoPin > 0) {
+            _sensorConnected = true;
+            _assumed = true;
+            attachInterrupt(digitalPinToInterrupt(_echoPin), echoISR, CHANGE);
+            Serial.println("💧 Water Level Monitor assumed present (cached), confirming...");
+        } else if (isConnected()) {
             _sensorConnected = true;
+            _confirmed = true; // The probe echoed
+            // From here on echoes are timed by the interrupt, not by ping_cm()
+            attachInterrupt(digitalPinToInterrupt(_echoPin), echoISR, CHANGE);
             Serial.println("💧 Water Level Monitor detected.");
         } else {
             _sensorConnected = false;
             Serial.println("⚠️ Water Level Sensor not detected. Skipping module.");
         }
+        return _sensorConnected;
+    }
+
+    bool isPresent() {
+        return _sensorConnected;
+    }
+
+    bool isConfirmed() {
+        return _confirmed;
     }
 
     bool isConnected() {
@@ -38,17 +218,79 @@ namespace WaterLevelMonitor {
         return (us > 0); // Returns true only if a valid echo is received
     }
 
+    void update() {
+        if (!_sensorConnected) return;
+
+        if (_assumed && !_confirmed && millis() - _beginMs > SONAR_CONFIRM_MS) {
+            _sensorConnected = false;
+            detachInterrupt(digitalPinToInterrupt(_echoPin));
+            Serial.println("⚠️ Water Level Sensor did not answer. Skipping module.");
+            return;
+        }
+
+        // The old slope says nothing about the new pump state; read right away
+        bool pumpRunning = _pumpRunning;
+        if (pumpRunning != _lastPumpRunning) {
+            _lastPumpRunning = pumpRunning;
+            _readingCount = 0;
+            _readingIndex = 0;
+            _rate = 0.0;
+            if (!_burstActive) _nextReadingMs = millis();
+        }
+
+        if (_pingInFlight) {
+            if (_echoDone) {
+                unsigned long width = _echoEnd - _echoStart;
+                _pingInFlight = false;
+                if (width > 0 && width < (unsigned long)MAX_DISTANCE * US_ROUNDTRIP_CM) {
+                    addSample((float)width / US_ROUNDTRIP_CM);
+                }
+            } else if (micros() - _pingStartMicros > ECHO_TIMEOUT_US) {
+                _pingInFlight = false; // No echo: keep the cached value
+            }
+            if (!_pingInFlight && _burstPings >= SONAR_MEDIAN_SAMPLES) finishReading();
+            return;
+        }
+
+        if (!_burstActive) {
+            if ((long)(millis() - _nextReadingMs) >= 0) startReading();
+        } else if (millis() - _lastPingMs >= SONAR_PING_INTERVAL_MS) {
+            startPing();
+        }
+    }
+
     float getLevel() {
         if (!_sensorConnected) {
             return -1.0; // Indicate no reading if the sensor is not connected
         }
-        
-        unsigned int us = _sonar.ping_cm();
-        if (us == 0) {
-            return -1.0; // Indicate no reading from sensor
+
+        if (_cachedDistance < 0 || millis() - _cachedTimestamp > _intervalMs + SONAR_STALE_MS) {
+            return -1.0; // Indicate no recent reading from sensor
         }
-        
-        return (float)us;
+
+        return _cachedDistance;
+    }
+
+    uint32_t getLevelTimestamp() {
+        return _cachedTimestamp;
+    }
+
+    void setThresholds(float pumpOnPercent, float pumpOffPercent) {
+        _pumpOnPercent = pumpOnPercent;
+        _pumpOffPercent = pumpOffPercent;
+    }
+
+    void setPumpRunning(bool running) {
+        _pumpRunning = running;
+    }
+
+    float getRate() {
+        float span = _maxDistance - _minDistance;
+        return -_rate * 60.0 * 100.0 / span;
+    }
+
+    uint32_t getInterval() {
+        return _intervalMs;
     }
 
     void calibrate(float minDist, float maxDist) {
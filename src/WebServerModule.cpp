@@ -0,0 +1,319 @@
+// WebServerModule.cpp
+
+#include "WebServerModule.h"
+#include <ESPAsyncWebServer.h>
+#include <LittleFS.h>
+#include <Preferences.h>
+#include <ArduinoJson.h>
+#include <stdarg.h>
+#include <time.h>
+#include "MetricHistory.h"
+
+#define SNAPSHOT_SIZE (128 + CT_MAX_CHANNELS * 12) // Base fields plus every CT circuit
+#define HISTORY_CHUNK 32 // Buckets fetched per query while streaming
+
+namespace WebServerModule {
+    static AsyncWebServer _server(80);
+    static AsyncWebSocket _ws("/ws");
+    static char _lastSnapshot[SNAPSHOT_SIZE] = "";
+    static volatile bool _clientJoined = false;
+    static unsigned long _restartAtMs = 0;
+    static bool _saveRequested = false; // Journal commit asked for before the restart
+    static unsigned long _lastCleanupMs = 0;
+    static bool _ctsClipped = false; // Logged the first frame that lost CT columns
+
+    static void onSocketEvent(AsyncWebSocket*, AsyncWebSocketClient*, AwsEventType type, void*, uint8_t*, size_t) {
+        // Runs in the TCP task: only flag it, loop() sends the next frame to everyone
+        if (type == WS_EVT_CONNECT) _clientJoined = true;
+    }
+
+    #define MAX_RESERVED_PINS 12
+
+    enum PinRole {
+        PIN_INPUT,         // Any GPIO
+        PIN_PULLUP_INPUT,  // Needs the internal pull-up, so not 34-39
+        PIN_OUTPUT,        // Not the input-only 34-39
+        PIN_ADC1,          // Sampled by the ADC DMA, 32-39 only
+    };
+
+    struct PinKey {
+        const char* key;
+        PinRole role;
+    };
+
+    static const PinKey PIN_KEYS[] = {
+        { "triggerPin",  PIN_OUTPUT },
+        { "echoPin",     PIN_INPUT },
+        { "motorPin",    PIN_OUTPUT },
+        { "ctPin",       PIN_ADC1 },
+        { "greenLedPin", PIN_OUTPUT },
+        { "redLedPin",   PIN_OUTPUT },
+        { "buttonPin",   PIN_PULLUP_INPUT },
+    };
+    #define PIN_KEY_COUNT (sizeof(PIN_KEYS) / sizeof(PIN_KEYS[0]))
+
+    static int _reservedPins[MAX_RESERVED_PINS];
+    static uint8_t _reservedCount = 0;
+
+    static bool isGpio(int pin) {
+        if (pin < 0 || pin > 39) return false;
+        if (pin >= 6 && pin <= 11) return false; // SPI flash
+        return pin != 20 && pin != 24 && !(pin >= 28 && pin <= 31); // Not bonded out
+    }
+
+    static bool fitsRole(int pin, PinRole role) {
+        if (!isGpio(pin)) return false;
+        switch (role) {
+            case PIN_ADC1:         return pin >= 32;
+            case PIN_OUTPUT:
+            case PIN_PULLUP_INPUT: return pin < 34;
+            default:               return true;
+        }
+    }
+
+    static bool isReserved(int pin) {
+        for (uint8_t i = 0; i < _reservedCount; i++) {
+            if (_reservedPins[i] == pin) return true;
+        }
+        return false;
+    }
+
+    static void onSaveGpioConfig(AsyncWebServerRequest* request, uint8_t* data, size_t len, size_t index, size_t total) {
+        // The form is tiny; anything that does not arrive in one chunk is rejected
+        if (index != 0 || len != total) {
+            request->send(413, "text/plain", "Config too large");
+            return;
+        }
+
+        StaticJsonDocument<384> doc;
+        if (deserializeJson(doc, data, len)) {
+            request->send(400, "text/plain", "Invalid JSON");
+            return;
+        }
+
+        // Nothing is written unless every pin suits its role and is used once
+        int pins[PIN_KEY_COUNT];
+        for (size_t k = 0; k < PIN_KEY_COUNT; k++) {
+            const char* key = PIN_KEYS[k].key;
+            if (!doc[key].is<int>() || !fitsRole(doc[key].as<int>(), PIN_KEYS[k].role)) {
+                request->send(400, "text/plain", String("Invalid ") + key);
+                return;
+            }
+            pins[k] = doc[key].as<int>();
+            if (isReserved(pins[k])) {
+                request->send(400, "text/plain", String(key) + " is used by the firmware");
+                return;
+            }
+            for (size_t other = 0; other < k; other++) {
+                if (pins[other] == pins[k]) {
+                    request->send(400, "text/plain", String(key) + " duplicates " + PIN_KEYS[other].key);
+                    return;
+                }
+            }
+        }
+
+        Preferences prefs;
+        prefs.begin("gpio", false);
+        for (size_t k = 0; k < PIN_KEY_COUNT; k++) {
+            prefs.putInt(PIN_KEYS[k].key, pins[k]);
+        }
+        prefs.end();
+
+        request->send(200, "application/json", "{\"saved\":true}");
+        Serial.println("🔧 GPIO configuration saved, restarting...");
+        _restartAtMs = millis() + 1000; // Let the response go out first
+    }
+
+    // Streams /api/history in chunks so a full day of minutes (~60 KB of JSON)
+    // never sits in RAM: rows are queried HISTORY_CHUNK at a time and
+    // copied out as the TCP window allows.
+    struct HistoryStream {
+        HistoryMetric metric;
+        HistoryTier tier;
+        uint32_t next;          // Next bucket start to query, seconds since boot
+        uint32_t to;
+        uint32_t unixOffset;    // Added to every time, 0 when the clock is not set
+        HistoryPoint points[HISTORY_CHUNK];
+        uint8_t pointCount;
+        uint8_t pointIndex;
+        bool started;
+        bool finished;
+        bool firstRow;
+        char text[128];
+        uint8_t textLength;
+        uint8_t textSent;
+
+        // Formats the next piece of the document into text; false at the end
+        bool produce() {
+            if (finished) return false;
+            textSent = 0;
+            if (!started) {
+                started = true;
+                textLength = snprintf(text, sizeof(text),
+                    "{\"metric\":\"%s\",\"res\":%lu,\"unix\":%s,\"cols\":[\"t\",\"min\",\"max\",\"mean\",\"last\"],\"rows\":[",
+                    MetricHistory::getMetricName(metric), (unsigned long)MetricHistory::getResolution(tier),
+                    unixOffset ? "true" : "false");
+                return true;
+            }
+            if (pointIndex == pointCount) {
+                pointCount = MetricHistory::query(metric, tier, next, to, points, HISTORY_CHUNK);
+                pointIndex = 0;
+                if (pointCount == 0) {
+                    finished = true;
+                    textLength = snprintf(text, sizeof(text), "]}");
+                    return true;
+                }
+                next = points[pointCount - 1].time + MetricHistory::getResolution(tier);
+            }
+            const HistoryPoint& point = points[pointIndex++];
+            textLength = snprintf(text, sizeof(text), "%s[%lu,%.3f,%.3f,%.3f,%.3f]", firstRow ? "" : ",",
+                (unsigned long)(point.time + unixOffset), point.min, point.max, point.mean, point.last);
+            firstRow = false;
+            return true;
+        }
+    };
+
+    // GET /api/history?metric=power&res=60[&from=..&to=..]; res is 1, 60 or
+    // 3600 s, from/to are Unix seconds once NTP is set, else seconds since boot
+    static void onHistory(AsyncWebServerRequest* request) {
+        HistoryMetric metric = HISTORY_POWER;
+        HistoryTier tier = HISTORY_MINUTES;
+        if (request->hasParam("metric") && !MetricHistory::parseMetric(request->getParam("metric")->value().c_str(), metric)) {
+            request->send(400, "text/plain", "Unknown metric");
+            return;
+        }
+        if (request->hasParam("res") && !MetricHistory::parseResolution(request->getParam("res")->value().toInt(), tier)) {
+            request->send(400, "text/plain", "res must be 1, 60 or 3600");
+            return;
+        }
+
+        time_t now = time(NULL);
+        uint32_t unixOffset = (now > 1600000000) ? now - MetricHistory::now() : 0;
+        uint32_t from = request->hasParam("from") ? strtoul(request->getParam("from")->value().c_str(), NULL, 10) : 0;
+        uint32_t to = request->hasParam("to") ? strtoul(request->getParam("to")->value().c_str(), NULL, 10) : 0xFFFFFFFF;
+        from = from > unixOffset ? from - unixOffset : 0;
+        if (to < unixOffset) {
+            request->send(400, "text/plain", "Range before boot");
+            return;
+        }
+        to -= unixOffset;
+
+        std::shared_ptr<HistoryStream> stream = std::make_shared<HistoryStream>();
+        stream->metric = metric;
+        stream->tier = tier;
+        stream->next = from;
+        stream->to = to;
+        stream->unixOffset = unixOffset;
+        stream->firstRow = true;
+
+        AsyncWebServerResponse* response = request->beginChunkedResponse("application/json",
+            [stream](uint8_t* buffer, size_t maxLen, size_t) -> size_t {
+                size_t written = 0;
+                while (written < maxLen) {
+                    if (stream->textSent == stream->textLength && !stream->produce()) break;
+                    size_t n = min((size_t)(stream->textLength - stream->textSent), maxLen - written);
+                    memcpy(buffer + written, stream->text + stream->textSent, n);
+                    stream->textSent += n;
+                    written += n;
+                }
+                return written;
+            });
+        request->send(response);
+    }
+
+    void reservePins(const int* pins, uint8_t count) {
+        for (uint8_t i = 0; i < count && _reservedCount < MAX_RESERVED_PINS; i++) {
+            _reservedPins[_reservedCount++] = pins[i];
+        }
+    }
+
+    void begin() {
+        if (!LittleFS.begin(true)) {
+            Serial.println("⚠️ LittleFS mount failed, dashboard unavailable.");
+        }
+
+        _ws.onEvent(onSocketEvent);
+        _server.addHandler(&_ws);
+
+        _server.on("/save-gpio-config", HTTP_POST,
+            [](AsyncWebServerRequest*) {}, NULL, onSaveGpioConfig);
+        _server.on("/api/history", HTTP_GET, onHistory);
+
+        // Serves file.gz when present (see scripts/gzip_data.py) with a long cache
+        _server.serveStatic("/", LittleFS, "/")
+            .setDefaultFile("dashboard.html")
+            .setCacheControl("max-age=86400");
+
+        _server.onNotFound([](AsyncWebServerRequest* request) {
+            request->send(404, "text/plain", "Not found");
+        });
+
+        _server.begin();
+        Serial.println("🌐 Local dashboard server started on port 80.");
+    }
+
+    // Appends with snprintf; returns false once the buffer is full
+    static bool append(char* buffer, size_t size, size_t& length, const char* format, ...) {
+        va_list args;
+        va_start(args, format);
+        int written = vsnprintf(buffer + length, size - length, format, args);
+        va_end(args);
+        if (written < 0 || length + written >= size) return false;
+        length += written;
+        return true;
+    }
+
+    void publish(const MeasurementFrame& frame, bool pumpRunning) {
+        if (_ws.count() == 0) return;
+
+        // Values are compared at the precision they are sent with
+        char body[SNAPSHOT_SIZE];
+        size_t bodyLength = 0;
+        bool ok = append(body, sizeof(body), bodyLength, "\"lvl\":%.1f,\"p\":%.1f,\"e\":%.4f,\"ct\":%.2f,\"thd\":%.0f,\"v\":%.0f,\"pf\":%.2f,\"hz\":%.1f,\"pump\":%d",
+            frame.waterLevelPercent, frame.power, frame.energyKWh, frame.ctCurrent, frame.currentTHD,
+            frame.voltage, frame.powerFactor, frame.frequency, pumpRunning ? 1 : 0);
+        if (!ok) return; // Out-of-range values: skip the frame
+        if (frame.ctChannels > 1) {
+            // Per-circuit currents in CTManager order; circuits that do not
+            // fit are left out rather than the whole frame (one byte is kept
+            // for the closing bracket)
+            uint8_t c = 0;
+            if (append(body, sizeof(body) - 1, bodyLength, ",\"cts\":[")) {
+                while (c < frame.ctChannels &&
+                       append(body, sizeof(body) - 1, bodyLength, "%s%.2f", c ? "," : "", frame.ctCurrents[c])) {
+                    c++;
+                }
+                append(body, sizeof(body), bodyLength, "]");
+            }
+            body[bodyLength] = '\0'; // Cut what a failed append left behind
+            if (c < frame.ctChannels && !_ctsClipped) {
+                _ctsClipped = true;
+                Serial.printf("⚠️ Dashboard frame too long, sending %u of %u circuits.\n", c, frame.ctChannels);
+            }
+        }
+
+        bool joined = _clientJoined;
+        if (!joined && strcmp(body, _lastSnapshot) == 0) return;
+        _clientJoined = false;
+        strcpy(_lastSnapshot, body);
+
+        char message[SNAPSHOT_SIZE + 24];
+        int length = snprintf(message, sizeof(message), "{\"t\":%lu,%s}", (unsigned long)frame.timestampMs, body);
+        _ws.textAll(message, length);
+    }
+
+    void loop() {
+        if (millis() - _lastCleanupMs > 1000) {
+            _lastCleanupMs = millis();
+            _ws.cleanupClients();
+        }
+        if (_restartAtMs != 0 && (long)(millis() - _restartAtMs) >= 0) {
+            // Energy since the last journal record would be lost otherwise
+            if (!_saveRequested) {
+                _saveRequested = true;
+                MeteringTask::requestSave();
+            }
+            if (MeteringTask::isSaved() || millis() - _restartAtMs > 2000) ESP.restart();
+        }
+    }
+}
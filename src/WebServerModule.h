@@ -0,0 +1,25 @@
+// WebServerModule.h
+
+#ifndef WEBSERVER_MODULE_H
+#define WEBSERVER_MODULE_H
+
+#include <Arduino.h>
+#include "MeteringTask.h"
+
+namespace WebServerModule {
+    // Serves data/ from LittleFS, the /ws snapshot stream, /api/history
+    // (MetricHistory rollups) and /save-gpio-config
+    void begin();
+
+    // Pins fixed in firmware (ACS712, ZMPT, status LEDs, extra CTs) that a
+    // saved GPIO config must not reuse; call before begin()
+    void reservePins(const int* pins, uint8_t count);
+
+    // Pushes one compact frame to WebSocket clients when the values changed
+    void publish(const MeasurementFrame& frame, bool pumpRunning);
+
+    // Housekeeping: drops dead clients, restarts after a config save
+    void loop();
+}
+
+#endif // WEBSERVER_MODULE_H
@@ -2,10 +2,25 @@
 #include <WiFi.h>
 #include <WiFiManager.h>
 
+#define WIFI_CONNECT_TIMEOUT_MS 20000 // Before falling back to the portal
+
 namespace WiFiModule
 {
     static WiFiManager _wifiManager;
     static int _redLed, _greenLed;
+    static bool _portalActive = false;
+    static bool _wasConnected = false;
+    static bool _everConnected = false;  // Later outages just wait for the router
+    static unsigned long _connectStartMs = 0;
+
+    static void startPortal()
+    {
+        String apName = getUniqueId();
+        Serial.printf("📶 Starting WiFi setup portal '%s'.\n", apName.c_str());
+        _wifiManager.setConfigPortalBlocking(false);
+        _wifiManager.startConfigPortal(apName.c_str());
+        _portalActive = true;
+    }
 
     void begin(int redLedPin, int greenLedPin)
     {        
@@ -16,22 +31,49 @@ namespace WiFiModule
         pinMode(_greenLed, OUTPUT);
         digitalWrite(_redLed, HIGH);
         digitalWrite(_greenLed, LOW);
-        String apName = getUniqueId();
 
-        if (!_wifiManager.autoConnect(apName.c_str()))
+        // autoConnect() would wait for the saved network; join it in the background instead
+        WiFi.mode(WIFI_STA);
+        if (_wifiManager.getWiFiIsSaved())
         {
-            Serial.println("❌ Failed to connect, starting AP mode.");
+            WiFi.begin();
+            _connectStartMs = millis();
+        }
+        else
+        {
+            startPortal();
         }
+    }
 
-        // This part needs to be in the main loop to not block
-        // during autoConnect
-        if (isConnected())
+    void loop()
+    {
+        if (_portalActive)
+        {
+            _wifiManager.process();
+        }
+
+        bool connected = isConnected();
+        if (connected && !_wasConnected)
         {
             digitalWrite(_redLed, LOW);
             digitalWrite(_greenLed, HIGH);
             Serial.println("WiFi Connected!");
             Serial.print("IP: ");
             Serial.println(WiFi.localIP());
+            _everConnected = true;
+        }
+        else if (!connected && _wasConnected)
+        {
+            digitalWrite(_redLed, HIGH);
+            digitalWrite(_greenLed, LOW);
+            Serial.println("⚠️ WiFi lost, reconnecting...");
+        }
+        _wasConnected = connected;
+
+        if (!connected && !_portalActive && !_everConnected && millis() - _connectStartMs > WIFI_CONNECT_TIMEOUT_MS)
+        {
+            Serial.println("❌ Failed to connect, starting AP mode.");
+            startPortal();
         }
     }
 
@@ -4,7 +4,12 @@
 #include <Arduino.h>
 
 namespace WiFiModule {
+    // Non-blocking: joins the saved network, or opens the WiFiManager
+    // portal (no saved network, or no connection within 20 s)
     void begin(int redLedPin, int greenLedPin);
+
+    // Runs the portal and updates the LEDs; call regularly
+    void loop();
     bool isConnected();
     String getIP();
     void resetSettings();
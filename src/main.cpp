@@ -11,39 +11,100 @@
 #include "WaterPumpModule.h"
 #include "EnergyMeterModule.h"
 #include "CTModule.h"
+#include "CTManager.h"
 #include "MQTTModule.h"
+#include "ADCSampler.h"
+#include "MeteringTask.h"
+#include "TelemetryPipeline.h"
+#include "StoreForward.h"
+#include "PartitionFlashStorage.h"
+#include "WebServerModule.h"
+#include "ReportFilter.h"
+#include "TelemetrySink.h"
+#include "TelemetrySinks.h"
+#include "MetricHistory.h"
+#include "Scheduler.h"
+#include "Diagnostics.h"
+#include "ADCCapture.h"
+#include "ADCReplay.h"
+#include "BootSequence.h"
+#include "CalibrationCache.h"
+#include "Connectivity.h"
+#include <Preferences.h>
+#include <LittleFS.h>
 
 // --- Hardware Pins ---
-const int ledPinRed      = 14;   // WiFi Red LED
-const int ledPinGreen    = 13;   // WiFi Green LED
+// Defaults; pins saved from config.html ("gpio" preferences) override them at boot
+int ledPinRed            = 14;   // WiFi Red LED
+int ledPinGreen          = 13;   // WiFi Green LED
 
-const int motorRelayPin  = 26;
+int motorRelayPin        = 26;
 
 const int acs712Pin      = 34;
+const int voltagePin     = 36;   // ZMPT101B (optional)
 
-const int triggerPin     = 5;
-const int echoPin        = 4;
+int triggerPin           = 5;
+int echoPin              = 4;
 
-const int ctPin          = 35;
+int ctPin                = 35;   // Main CT, first CTManager channel
 
-const int buttonPin      = 22; // Data toggle button
+int buttonPin            = 22; // Data toggle button
 const int blueLedPin    = 17; // Data status LED (Orange)
 const int orangeLedPin      = 16; // Data status LED (Blue)
 
+// --- ADC Sampling ---
+const uint32_t adcSampleRateHz = 10000; // Per channel, fixed DMA rate
+const uint32_t meteringPeriodMs = 250;  // Measurement frame interval
+
+// --- MQTT Telemetry ---
+const uint32_t telemetryCadenceMs = 5000; // Batch publish interval
+const uint16_t telemetryMaxBatch  = 32;   // Samples per batch (at most)
+const TelemetryEncoding telemetryEncoding = TELEMETRY_JSON; // TELEMETRY_BINARY: ~7x smaller, .../telemetry/bin
+const uint32_t offlineStoreIntervalMs = 5000; // Record spacing while offline
+PartitionFlashStorage telemetryStorage("telemetry");
+
+// --- loop() jobs (run earliest deadline first) ---
+Scheduler loopScheduler("loop");
+int8_t pumpJob = -1;
+int8_t sonarCheckJobId = -1;
+bool frameReady = false; // New frame not yet seen by the pump job
+
 // --- Blynk state ---
 bool isSendingEnabled = false;   // Start in the 'sending' state
-BlynkTimer timer;
+volatile bool blynkOnline = false; // loop() owns the Blynk client while set
 volatile bool buttonPressed = false;
 
+// --- Blynk reporting (report by exception) ---
+// absolute deadband, % deadband, min interval ms, max silence (heartbeat) ms
+ReportFilter powerReport(5.0f, 2.0f, 1000, 60000);      // W
+ReportFilter energyReport(0.001f, 0.0f, 5000, 300000);  // kWh
+ReportFilter ctReport(0.05f, 2.0f, 1000, 60000);        // A
+ReportFilter levelReport(1.0f, 0.0f, 1000, 60000);      // %
+
 // --- Debounce ---
 volatile unsigned long lastButtonPress = 0;  // store last press time
 const unsigned long debounceDelay = 350;     // ms
 
 // --- Calibration ---
-const float voltageCalibration = 225.0f;
+const float voltageCalibration = 225.0f;   // Assumed mains voltage without a voltage sensor
+const float zmptVoltsPerStep   = 0.45f;    // ZMPT101B: trim with EnergyMeterModule::calibrateVoltage()
+const float zmptPhaseDegrees   = 2.0f;     // ZMPT101B output lag behind mains
 const float sensitivity        = 185.0f;   // For ACS712-5A (change if using 20A or 30A)
 const float ctCalibration = 1550.5f; // For ZMCT103C-5A
 
+// --- Per-circuit CTs (besides ctPin) ---
+// Free ADC1 inputs: GPIO 32, 33, 39 (37, 38 where exposed); one DMA scan covers all
+struct CTCircuit {
+  int pin;
+  float calibration;
+  const char* name;
+};
+const CTCircuit extraCircuits[] = {
+  // { 32, 1550.5f, "kitchen" },
+  // { 33, 1550.5f, "heater" },
+  { -1, 0.0f, NULL } // End of list
+};
+
 // --- Tank Calibration ---
 float tankMinDistance = 8.0;   // Full tank (distance in cm)
 float tankMaxDistance = 50.0;  // Empty tank (distance in cm)
@@ -69,6 +130,7 @@ bool isCTConnected = false;
 BLYNK_WRITE(V3) {  // Manual Pump Override
   manualOverride = param.asInt();
   Serial.printf("📱 Manual Override set to: %d\n", manualOverride);
+  loopScheduler.trigger(pumpJob);
 }
 
 BLYNK_WRITE(V4) {  // Auto Mode Toggle
@@ -78,26 +140,47 @@ BLYNK_WRITE(V4) {  // Auto Mode Toggle
 
 
 
-// --- Send data to Blynk ---
-void sendDataToBlynk() {
-  if (isSendingEnabled) {
+// --- Blynk sink ---
+// Gets every frame; each metric is only written when it changed
+// meaningfully or its heartbeat is due
+class BlynkSink : public TelemetrySink {
+public:
+  BlynkSink() : TelemetrySink("blynk", 0) {}
+protected:
+  void publish(const MeasurementFrame& frame) override {
+    if (!blynkOnline) return;
     if (isEnergyMeterConnected) {
-      float power = EnergyMeterModule::getPower();
-      float cumulativeEnergy = EnergyMeterModule::getCumulativeEnergy();
-      Blynk.virtualWrite(V0, power);
-      Blynk.virtualWrite(V1, cumulativeEnergy); 
+      if (powerReport.shouldReport(frame.power, frame.timestampMs)) {
+        Blynk.virtualWrite(V0, frame.power);
+      }
+      if (energyReport.shouldReport(frame.energyKWh, frame.timestampMs)) {
+        Blynk.virtualWrite(V1, frame.energyKWh); 
+      }
     }
-    if (isCTConnected) {
-      float current = CTModule::getCurrent();
-      Blynk.virtualWrite(V5, current);
+    if (isCTConnected && ctReport.shouldReport(frame.ctCurrent, frame.timestampMs)) {
+      Blynk.virtualWrite(V5, frame.ctCurrent);
     }
-    if (isWaterSensorConnected) {
-      float levelPercent = WaterLevelMonitor::getLevelPercent();
-      Blynk.virtualWrite(V2, levelPercent);
+    if (isWaterSensorConnected && levelReport.shouldReport(frame.waterLevelPercent, frame.timestampMs)) {
+      Blynk.virtualWrite(V2, frame.waterLevelPercent);
     }
   }
+};
+
+// Resend everything after (re)connecting so the app is current
+BLYNK_CONNECTED() {
+  powerReport.reset();
+  energyReport.reset();
+  ctReport.reset();
+  levelReport.reset();
 }
 
+// --- Telemetry sinks (each gets the same frame, at its own rate) ---
+BlynkSink blynkSink;
+MqttSink mqttSink(0);             // TelemetryPipeline does its own batching
+WebSocketSink webSocketSink(0);   // Pushes only when values changed
+SerialSink serialSink(3000);      // Status line every 3s
+HistorySink historySink;          // On-device rollups for /api/history
+
 // --- ISR with debounce ---
 void IRAM_ATTR buttonPressHandler() {
   unsigned long currentTime = millis();
@@ -109,9 +192,163 @@ void IRAM_ATTR buttonPressHandler() {
 
 String deviceID;
 
+// --- Load GPIO overrides saved by the local config page ---
+void loadGpioConfig() {
+  Preferences prefs;
+  prefs.begin("gpio", true);
+  triggerPin    = prefs.getInt("triggerPin", triggerPin);
+  echoPin       = prefs.getInt("echoPin", echoPin);
+  motorRelayPin = prefs.getInt("motorPin", motorRelayPin);
+  ctPin         = prefs.getInt("ctPin", ctPin);
+  ledPinGreen   = prefs.getInt("greenLedPin", ledPinGreen);
+  ledPinRed     = prefs.getInt("redLedPin", ledPinRed);
+  buttonPin     = prefs.getInt("buttonPin", buttonPin);
+  prefs.end();
+}
+
+// --- Cloud links, brought up by the connectivity task ---
+bool blynkConnect() {
+  if (Blynk.connect(3000)) {
+    Serial.println("✅ Blynk connected!");
+    blynkOnline = true;
+    return true;
+  }
+  Serial.println("⚠️ Blynk connection failed, will retry...");
+  return false;
+}
+
+bool blynkIsOnline() {
+  return blynkOnline;
+}
+
+// Zeros learned while idle; the cache only writes values that really moved
+void saveZerosJob() {
+  if (isEnergyMeterConnected && EnergyMeterModule::getZero().isLearned()) {
+    const OffsetTracker& zero = EnergyMeterModule::getZero();
+    CalibrationCache::setACSZero(zero.getMidpoint(), zero.getNoise());
+  }
+  for (uint8_t c = 0; c < CTManager::getChannelCount(); c++) {
+    CTChannel* ct = CTManager::getChannel(c);
+    if (!ct->isConnected() || !ct->getZero().isLearned()) continue;
+    CalibrationCache::setCTZero(ct->getPin(), ct->getZero().getMidpoint(), ct->getZero().getNoise());
+  }
+}
+
+// --- loop() jobs ---
+void blynkJob() {
+  if (!blynkOnline) return;
+  if (!Blynk.connected()) {
+    blynkOnline = false; // The connectivity task reconnects
+    Serial.println("⚠️ Blynk connection lost.");
+    return;
+  }
+  Blynk.run();
+}
+
+void buttonJob() {
+  if (!buttonPressed) return;
+  buttonPressed = false;
+  isSendingEnabled = !isSendingEnabled;
+  blynkSink.setEnabled(isSendingEnabled);
+  mqttSink.setEnabled(isSendingEnabled);
+
+  if (isSendingEnabled) {
+    digitalWrite(blueLedPin, HIGH);
+    digitalWrite(orangeLedPin, LOW);
+    Serial.println("🟢 Data sending enabled.");
+  } else {
+    digitalWrite(blueLedPin, LOW);
+    digitalWrite(orangeLedPin, HIGH);
+    Serial.println("🔴 Data sending paused.");
+  }
+}
+
+// Measurements come from the metering task; one frame per metering cycle,
+// fanned out to every sink
+void frameJob() {
+  if (MeteringTask::poll()) {
+    TelemetryHub::dispatch(MeteringTask::snapshot());
+    frameReady = true;
+  }
+}
+
+void sinksJob() {
+  TelemetryHub::loop();
+}
+
+void pumpControlJob() {
+  if (isWaterPumpConnected && frameReady && MeteringTask::snapshot().waterLevelPercent >= 0) {
+    BootSequence::mark(BOOT_CONTROL);
+  }
+  if (isWaterPumpConnected && (frameReady || manualOverride)) {
+    float maxLevel = pumpOffLevelPercent;   // full tank
+    float minLevel = pumpOnLevelPercent;    // empty tank
+
+    WaterPumpModule::update(
+      MeteringTask::snapshot().waterLevelPercent,
+      maxLevel,
+      minLevel,
+      autoModeEnabled,
+      manualOverride
+    );
+    WaterLevelMonitor::setPumpRunning(WaterPumpModule::isRunning()); // Sonar samples faster while it runs
+  }
+  frameReady = false;
+
+  // Reset manual override after action
+  if (manualOverride) {
+    manualOverride = false;
+  }
+}
+
+// Prints both job tables when a job broke its budget or deadline
+void healthJob() {
+  static uint32_t lastOverruns = 0;
+  uint32_t overruns = loopScheduler.getOverrunCount() + MeteringTask::getScheduler().getOverrunCount();
+  if (overruns == lastOverruns) return;
+  lastOverruns = overruns;
+  Serial.println("⚠️ Job overruns detected:");
+  Diagnostics::printStats();
+}
+
+// "stats" / "stats reset" on the serial monitor
+void consoleJob() {
+  Diagnostics::handleSerial();
+}
+
+void diagnosticsJob() {
+  Diagnostics::publish();
+}
+
+// The pump is only driven from a sonar that answered this boot
+void enableWaterPump() {
+  isWaterPumpConnected = true;
+  WaterPumpModule::turnOn();
+}
+
+// Keeps the cached sonar presence in line with what the sensor did this boot
+void sonarCheckJob() {
+  if (WaterLevelMonitor::isPresent() && !WaterLevelMonitor::isConfirmed()) return; // Still confirming
+  if (WaterLevelMonitor::isConfirmed()) {
+    if (!isWaterPumpConnected) enableWaterPump();
+  } else if (isWaterPumpConnected) {
+    // Cached sensor never echoed: no level, so no automatic pump
+    WaterPumpModule::turnOff();
+    isWaterPumpConnected = false;
+  }
+  CalibrationCache::setSonarPresent(WaterLevelMonitor::isConfirmed());
+  loopScheduler.setEnabled(sonarCheckJobId, false);
+}
+
+// Raw ADC recording started with "capture file|serial <s>"
+void captureJob() {
+  ADCCapture::loop();
+}
+
 void setup() {
+  Serial.setTxBufferSize(ADC_CAPTURE_TX_BUFFER); // Lets serial captures write without blocking
   Serial.begin(115200);
-  delay(DELAY);
+  // No settle delay: the pump and sensors must be up within a few hundred ms
 
   // Generate Unique Device ID
   char chipId[15];
@@ -119,21 +356,15 @@ void setup() {
   deviceID = "ESP32-" + String(chipId);
   Serial.println("Device ID: " + deviceID);
 
-  WiFi.disconnect(true);  // Disconnect and clear Wi-Fi credentials
-
   Serial.println("\n=== Smart Hub Booting... ===");
+  loadGpioConfig();
+  CalibrationCache::begin();
+  BootSequence::mark(BOOT_CONFIG);
 
-  // --- WiFi & Blynk Setup via WiFiModule ---
-  WiFiModule::begin(ledPinRed, ledPinGreen);
-
-  if (WiFiModule::isConnected()) {
-    Blynk.config(BLYNK_AUTH_TOKEN);
-    if (Blynk.connect(5000)) {
-      Serial.println("✅ Blynk connected!");
-    } else {
-      Serial.println("⚠️ Blynk connection failed, will retry...");
-    }
-  }
+  // --- Stage 1: local control, from cached calibration ---
+  // Relay to a known (off) state before anything slow
+  WaterPumpModule::begin(motorRelayPin);
+  BootSequence::mark(BOOT_PUMP);
 
   // --- Button & LEDs ---
   pinMode(buttonPin, INPUT_PULLUP);
@@ -148,26 +379,63 @@ void setup() {
   // --- Initialize Modules ---
   Serial.println("🔍 Starting module discovery...");
 
-  WaterLevelMonitor::begin(triggerPin, echoPin);
-  isWaterSensorConnected = WaterLevelMonitor::isConnected();
+  // A sonar seen on the last boot is not probed again (500 ms); it has to echo soon instead
+  bool sonarCached = false;
+  CalibrationCache::getSonarPresent(sonarCached);
+  isWaterSensorConnected = WaterLevelMonitor::begin(triggerPin, echoPin, sonarCached);
 
   if (isWaterSensorConnected) {
     WaterLevelMonitor::calibrate(tankMinDistance, tankMaxDistance);
-    WaterPumpModule::begin(motorRelayPin);
-    isWaterPumpConnected = true;
-    WaterPumpModule::turnOn();
+    WaterLevelMonitor::setThresholds(pumpOnLevelPercent, pumpOffLevelPercent);
+    // A cached sonar gets the pump from sonarCheckJob once it has echoed
+    if (WaterLevelMonitor::isConfirmed()) enableWaterPump();
     // Apply user-defined calibration
     Serial.println("✅ Water Level Calibration Applied:");
     Serial.printf("   Full tank distance: %.2f cm\n", tankMinDistance);
     Serial.printf("   Empty tank distance: %.2f cm\n", tankMaxDistance);
 }
 
+  // Start the DMA sampler before the modules that read from it
+  // Current, voltage and every CT are converted in the same pass, one frame
+  // per sample time; voltage goes next to the ACS712 to keep their skew small
+  uint8_t adcPins[ADC_SAMPLER_MAX_CHANNELS] = { (uint8_t)acs712Pin, (uint8_t)voltagePin, (uint8_t)ctPin };
+  uint8_t adcPinCount = 3;
+  for (const CTCircuit* circuit = extraCircuits; circuit->pin >= 0; circuit++) {
+    if (adcPinCount >= ADC_SAMPLER_MAX_CHANNELS) break;
+    adcPins[adcPinCount++] = circuit->pin;
+  }
+
+  // A capture copied to LittleFS as /replay.adc replaces the ADC, so field
+  // waveforms can be run through the metering code on the bench
+  LittleFS.begin(true);
+  uint32_t sampleRate = adcSampleRateHz;
+  if (ADCReplay::begin("/replay.adc", true, true)) {
+    ADCReplay::mapPins(adcPins, adcPinCount);
+    ADCSampler::setSource(ADCReplay::source);
+    sampleRate = ADCReplay::getHeader().sampleRateHz;
+    Serial.println("⚠️ Metering from /replay.adc, not from the sensors!");
+  }
+  ADCSampler::begin(adcPins, adcPinCount, sampleRate);
+
+  // Sensor zeros are learned online; start from the last boot's values
+  float zeroMidpoint, zeroNoise;
+  if (CalibrationCache::getACSZero(zeroMidpoint, zeroNoise)) EnergyMeterModule::restoreZero(zeroMidpoint, zeroNoise);
+  EnergyMeterModule::setVoltageSensor(voltagePin, zmptVoltsPerStep, zmptPhaseDegrees);
   EnergyMeterModule::begin(acs712Pin, voltageCalibration, sensitivity);
   isEnergyMeterConnected = EnergyMeterModule::isConnected();
 
 // ... after initializing other modules
-  CTModule::begin(ctPin, ctCalibration);
-  isCTConnected = CTModule::isConnected();
+  CTManager::addChannel(ctPin, ctCalibration, "main");
+  for (const CTCircuit* circuit = extraCircuits; circuit->pin >= 0; circuit++) {
+    CTManager::addChannel(circuit->pin, circuit->calibration, circuit->name);
+  }
+  CTManager::begin();
+  for (uint8_t c = 0; c < CTManager::getChannelCount(); c++) {
+    CTChannel* ct = CTManager::getChannel(c);
+    if (!ct->isConnected()) continue;
+    isCTConnected = true;
+    if (CalibrationCache::getCTZero(ct->getPin(), zeroMidpoint, zeroNoise)) ct->restoreZero(zeroMidpoint, zeroNoise);
+  }
 
 // Connect a known load (e.g., a 100W light bulb)
 // The current draw of a 100W bulb at 220V is approx. 0.45A.
@@ -179,103 +447,77 @@ void setup() {
 // CTModule::calibrate(0.45f); 
 
   Serial.println("✅ Module discovery complete.");
+  BootSequence::mark(BOOT_SENSORS);
+
+  // --- Telemetry fan-out ---
+  serialSink.setModules(isWaterSensorConnected, isEnergyMeterConnected, isCTConnected);
+  historySink.setModules(isEnergyMeterConnected, isCTConnected);
+  MetricHistory::begin();
+  blynkSink.setEnabled(isSendingEnabled);
+  mqttSink.setEnabled(isSendingEnabled);
+  TelemetryHub::addSink(&blynkSink);
+  TelemetryHub::addSink(&mqttSink);
+  TelemetryHub::addSink(&webSocketSink);
+  TelemetryHub::addSink(&serialSink);
+  TelemetryHub::addSink(&historySink);
+
+  // Sonar, CT and ACS712 measurements run on core 0 from here on
+  MeteringTask::begin(isWaterSensorConnected, isEnergyMeterConnected, isCTConnected, meteringPeriodMs);
+
+  // name, job, period ms, deadline ms, budget us
+  pumpJob = loopScheduler.addJob("pump", pumpControlJob, 50, 10, 2000);
+  loopScheduler.addJob("frame", frameJob, 20, 20, 5000);
+  loopScheduler.addJob("button", buttonJob, 50, 50, 200);
+  loopScheduler.addJob("blynk", blynkJob, 10, 50, 20000);
+  loopScheduler.addJob("sinks", sinksJob, 20, 50, 20000);
+  loopScheduler.addJob("health", healthJob, 60000, 0, 50000);
+  loopScheduler.addJob("console", consoleJob, 100, 0, 50000);
+  loopScheduler.addJob("diag", diagnosticsJob, 60000, 0, 20000);
+  loopScheduler.addJob("capture", captureJob, 20, 50, 20000);
+  sonarCheckJobId = loopScheduler.addJob("sonarcheck", sonarCheckJob, 1000, 0, 20000);
+  loopScheduler.addJob("zeros", saveZerosJob, 600000, 0, 50000); // NVS writes at most every 10 min
+  BootSequence::mark(BOOT_METERING);
+
+  // --- Stage 2: network, in the background ---
+  // Nothing below waits for WiFi, Blynk or MQTT
+  Blynk.config(BLYNK_AUTH_TOKEN);
+  MQTTModule::begin(MQTT_SERVER, MQTT_PORT, deviceID.c_str(), HIVE_USERNAME, HIVE_PASSWORD);
+  TelemetryPipeline::begin(deviceID.c_str(), telemetryCadenceMs, telemetryMaxBatch);
+  TelemetryPipeline::setEncoding(telemetryEncoding);
+  StoreForward::begin(&telemetryStorage, offlineStoreIntervalMs);
 
-  // Schedule send data every 15 sec
-  timer.setInterval(15000L, sendDataToBlynk);
-}
-
-void loop() {  // ✅ keep WiFi status & LEDs updated
-  Blynk.run();
-  timer.run();
-
-  // --- Handle button press ---
-  if (buttonPressed) {
-    buttonPressed = false;
-    isSendingEnabled = !isSendingEnabled;
-
-    if (isSendingEnabled) {
-      digitalWrite(blueLedPin, HIGH);
-      digitalWrite(orangeLedPin, LOW);
-      Serial.println("🟢 Data sending enabled.");
-    } else {
-      digitalWrite(blueLedPin, LOW);
-      digitalWrite(orangeLedPin, HIGH);
-      Serial.println("🔴 Data sending paused.");
-    }
-  }
-
-  // --- Read sensors ---
- float currentWaterLevel = -1.0;
-  float waterLevelPercent = -1.0;
-  if (isWaterSensorConnected) {
-    currentWaterLevel = WaterLevelMonitor::getLevel();
-    waterLevelPercent = WaterLevelMonitor::getLevelPercent();
-    // Serial.printf("💧 Water Level: %.2f cm (%.1f%%)\n", currentWaterLevel, waterLevelPercent);
-  }
-
-  // --- Water Pump Control ---
-  if (isWaterPumpConnected) {
-    float maxLevel = pumpOffLevelPercent;   // full tank
-    float minLevel = pumpOnLevelPercent;    // empty tank
-
-    WaterPumpModule::update(
-      waterLevelPercent,
-      maxLevel,
-      minLevel,
-      autoModeEnabled,
-      manualOverride
-    );
-  }
-
-  // Reset manual override after action
-  if (manualOverride) {
-    manualOverride = false;
-  }
+  WiFi.disconnect(true);  // Disconnect and clear Wi-Fi credentials
+  WiFiModule::begin(ledPinRed, ledPinGreen);
+  configTime(0, 0, "pool.ntp.org"); // UTC timestamps for buffered records
 
-  // --- Energy Meter Update ---
-  if (isEnergyMeterConnected) {
-    EnergyMeterModule::update();
-  }
-  //  --- CT Module Update ---
-  if (isCTConnected) {
-    CTModule::update();
+  // The GPIO form may not move a pin onto one the firmware owns
+  const int fixedPins[] = { acs712Pin, voltagePin, blueLedPin, orangeLedPin };
+  WebServerModule::reservePins(fixedPins, sizeof(fixedPins) / sizeof(fixedPins[0]));
+  for (const CTCircuit* circuit = extraCircuits; circuit->pin >= 0; circuit++) {
+    WebServerModule::reservePins(&circuit->pin, 1);
   }
 
-  // --- Debug Print every 2s ---
-  static unsigned long lastSerialPrint = 0;
-  if (millis() - lastSerialPrint > 3000) {
-    lastSerialPrint = millis();
-
-    Serial.printf("💧 Water Level: ");
-    if (isWaterSensorConnected) {
-      Serial.printf("💧 Water Level: %.2f cm (%.1f%%)\n", currentWaterLevel, waterLevelPercent);
-
-    } else {
-      Serial.printf("N/A");
-    }
+  // The dashboard shares port 80 with the WiFi setup portal, so it starts
+  // once WiFi is up; Blynk and MQTT retry every 5 s
+  Connectivity::onWiFiUp(WebServerModule::begin);
+  Connectivity::addLink("blynk", blynkConnect, blynkIsOnline, BOOT_BLYNK, 5000);
+  Connectivity::addLink("mqtt", MQTTModule::connect, MQTTModule::isConnected, BOOT_MQTT, 5000);
+  Connectivity::begin();
+
+  // Latency histograms: serial "stats" command and home_iot/<id>/diag
+  Diagnostics::begin(deviceID.c_str());
+  Diagnostics::addScheduler(&loopScheduler);
+  Diagnostics::addScheduler(&MeteringTask::getScheduler());
+  Diagnostics::addCommandHandler(ADCCapture::handleCommand);
+  Diagnostics::addCommandHandler(BootSequence::handleCommand);
+  Diagnostics::addCommandHandler(CalibrationCache::handleCommand);
+  Diagnostics::addCommandHandler(MetricHistory::handleCommand);
+}
 
-    Serial.printf(" | ⚡ Power: ");
-    if (isEnergyMeterConnected) {
-      Serial.printf("%.2f W | Total Units: %.4f kWh",
-        EnergyMeterModule::getPower(),
-        EnergyMeterModule::getCumulativeEnergy()
-      );
-    } else {
-      Serial.printf("N/A");
-    }
+void loop() {  // ✅ keep WiFi status & LEDs updated
+  // Runs due jobs and sleeps until the next release
+  loopScheduler.run(10);
 
-    Serial.printf(" | CT: ");
-    if (isCTConnected) {
-      Serial.printf("%.2f A", CTModule::getCurrent());
-    } else {
-      Serial.printf("N/A");
-    }
-    
-    
-    Serial.println();
-    
-  }
-  
   // 👉 Raw ADC values
 // int rawACS = analogRead(acs712Pin);
 // int rawCT = analogRead(ctPin);